@@ -0,0 +1,43 @@
+#include <cstdio>
+#include <string_view>
+
+#include "bench.hpp"
+
+void bench_request();
+void bench_headers();
+void bench_router();
+void bench_uri();
+void bench_form();
+void bench_response();
+void bench_pipeline();
+void bench_metrics();
+void bench_invalid();
+void bench_zero_copy();
+
+// Usage: mio_bench [--json] [prefix]
+//   --json   prints one JSON object per result instead of a table
+//   prefix   runs only the benchmarks whose names start with it, e.g. "router/"
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--json") {
+            mio::bench::format = mio::bench::output_format::json;
+        } else if (arg.starts_with("-")) {
+            std::fprintf(stderr, "usage: %s [--json] [prefix]\n", argv[0]);
+            return 1;
+        } else {
+            mio::bench::filter = arg;
+        }
+    }
+
+    bench_request();
+    bench_headers();
+    bench_router();
+    bench_uri();
+    bench_form();
+    bench_response();
+    bench_pipeline();
+    bench_metrics();
+    bench_invalid();
+    bench_zero_copy();
+}
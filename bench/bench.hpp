@@ -0,0 +1,85 @@
+#ifndef INCLUDE_mio_bench_bench_hpp
+#define INCLUDE_mio_bench_bench_hpp
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+namespace mio::bench {
+    enum class output_format {
+        text,
+        json, // One object per line, so that results of two releases can be diffed.
+    };
+
+    inline output_format format = output_format::text;
+
+    // Only the benchmarks whose names start with this are run.
+    inline std::string_view filter{};
+
+    [[nodiscard]] inline bool enabled(std::string_view name) noexcept {
+        return name.starts_with(filter);
+    }
+
+    // Whether any benchmark under `prefix` is run, for setup shared by a group.
+    [[nodiscard]] inline bool any_enabled(std::string_view prefix) noexcept {
+        return prefix.starts_with(filter) || filter.starts_with(prefix);
+    }
+
+    // Prints one result, e.g. report("parse_request/small", 41.2, "ns/op", 16777216).
+    inline void report(std::string_view name, double value, std::string_view unit, std::uint64_t iterations = 0) {
+        const auto n = static_cast<int>(name.size());
+        const auto u = static_cast<int>(unit.size());
+
+        if (format == output_format::json) {
+            // Names and units are plain ASCII without quotes, so nothing needs escaping.
+            std::printf("{\"name\":\"%.*s\",\"value\":%.2f,\"unit\":\"%.*s\",\"iterations\":%llu}\n", n, name.data(), value, u, unit.data(), static_cast<unsigned long long>(iterations));
+        } else if (iterations > 0) {
+            std::printf("%-48.*s %12.2f %-12.*s %12llu iterations\n", n, name.data(), value, u, unit.data(), static_cast<unsigned long long>(iterations));
+        } else {
+            std::printf("%-48.*s %12.2f %.*s\n", n, name.data(), value, u, unit.data());
+        }
+
+        std::fflush(stdout);
+    }
+
+    // Keeps the compiler from optimizing away a computed value.
+    template <typename T>
+    inline void do_not_optimize(const T& value) noexcept {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Runs f repeatedly for about `min_duration` and prints the time per iteration.
+    template <typename F>
+    void run(std::string_view name, F f, std::chrono::nanoseconds min_duration = std::chrono::milliseconds{200}) {
+        using clock = std::chrono::steady_clock;
+
+        if (!enabled(name)) {
+            return;
+        }
+
+        // Warm up.
+        for (int i = 0; i < 100; i++) {
+            f();
+        }
+
+        std::uint64_t iterations = 1;
+        for (;;) {
+            const auto start = clock::now();
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                f();
+            }
+            const auto elapsed = clock::now() - start;
+
+            if (elapsed >= min_duration) {
+                const auto ns = std::chrono::duration<double, std::nano>{elapsed}.count() / static_cast<double>(iterations);
+                report(name, ns, "ns/op", iterations);
+                return;
+            }
+
+            iterations *= 2;
+        }
+    }
+} // namespace mio::bench
+
+#endif // INCLUDE_mio_bench_bench_hpp
@@ -0,0 +1,31 @@
+#include "mio/url_encoded_fields.hpp"
+
+#include "bench.hpp"
+
+void bench_form() {
+    if (!mio::bench::any_enabled("form/")) {
+        return;
+    }
+
+    const std::string_view plain = "name=mio&email=mio%40example.com&age=20&country=jp&tag=cpp&tag=http&tag=server&page=2";
+    const std::string_view escaped = "title=Hello%2C+World%21&body=caf%C3%A9+au+lait+%26+croissants%0D%0A&tags=a%2Bb%2Cc";
+
+    mio::url_encoded_fields fields{};
+
+    mio::bench::run("form/parse/plain", [&] {
+        fields.reset();
+        mio::bench::do_not_optimize(fields.parse(plain));
+    });
+
+    mio::bench::run("form/parse/escaped", [&] {
+        fields.reset();
+        mio::bench::do_not_optimize(fields.parse(escaped));
+    });
+
+    fields.reset();
+    static_cast<void>(fields.parse(plain));
+
+    mio::bench::run("form/get", [&] {
+        mio::bench::do_not_optimize(fields.get("page"));
+    });
+}
@@ -0,0 +1,172 @@
+#include "mio/application.hpp"
+#include "mio/http_request.hpp"
+#include "mio/http_response.hpp"
+#include "mio/http_server.hpp"
+#include "mio/sockets/endpoint.hpp"
+#include "mio/sockets/socket.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <sys/socket.h>
+
+#include "bench.hpp"
+
+namespace {
+    constexpr auto min_duration = std::chrono::milliseconds{500};
+    constexpr std::size_t pipeline_depth = 16;
+
+    class application : public mio::application_base {
+    public:
+        application() {
+            get_router().get("/users/:id", [](const mio::http_request&) { return mio::http_response{200, "user"}; });
+        }
+    };
+
+    // Starts a server on a free loopback port. It runs until the process exits, so it is never destroyed.
+    std::uint16_t start_server() {
+        std::uint16_t port;
+        {
+            mio::sockets::socket probe{mio::sockets::address_family::inet, mio::sockets::socket_type::stream};
+            probe.listen(mio::sockets::endpoint::inet("127.0.0.1", 0));
+            port = probe.local_endpoint().port();
+        }
+
+        auto* server = new mio::http_server{std::make_unique<application>()};
+        std::thread{[server, port] { server->listen(mio::sockets::endpoint::inet("127.0.0.1", port)); }}.detach();
+
+        return port;
+    }
+
+    mio::sockets::socket connect(std::uint16_t port) {
+        const auto address = mio::sockets::endpoint::inet("127.0.0.1", port);
+
+        // The server may not be listening yet.
+        for (int retry = 0; retry < 1000; retry++) {
+            mio::sockets::socket client{mio::sockets::address_family::inet, mio::sockets::socket_type::stream};
+            if (::connect(client.descriptor(), address.data(), address.size()) == 0) {
+                return client;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
+        throw std::runtime_error{"cannot connect"};
+    }
+
+    // Reads one response and returns its size; every response to the same request has the same size.
+    std::size_t receive_response(mio::sockets::socket& client) {
+        std::string buffer{};
+        char chunk[4096];
+
+        for (;;) {
+            if (const auto end = buffer.find("\r\n\r\n"); end != std::string::npos) {
+                const auto pos = buffer.find("content-length: ");
+                if (pos == std::string::npos) {
+                    throw std::runtime_error{"no content-length"};
+                }
+
+                std::size_t content_length = 0;
+                const auto value = buffer.data() + pos + std::string_view{"content-length: "}.size();
+                std::from_chars(value, buffer.data() + buffer.size(), content_length);
+
+                const auto size = end + 4 + content_length;
+                while (buffer.size() < size) {
+                    buffer.append(chunk, client.receive(chunk, sizeof(chunk)));
+                }
+                return size;
+            }
+
+            const auto n = client.receive(chunk, sizeof(chunk));
+            if (n == 0) {
+                throw std::runtime_error{"connection closed"};
+            }
+            buffer.append(chunk, n);
+        }
+    }
+
+    void report(const char* name, std::size_t requests, std::chrono::steady_clock::duration elapsed) {
+        const auto seconds = std::chrono::duration<double>{elapsed}.count();
+        mio::bench::report(name, static_cast<double>(requests) / seconds, "req/s", requests);
+    }
+
+    // Sends `request` `pipeline_depth` at a time on one keep-alive connection.
+    void pipelined(const char* name, std::uint16_t port, std::string_view request) {
+        if (!mio::bench::enabled(name)) {
+            return;
+        }
+
+        auto client = connect(port);
+
+        client.send(request.data(), request.size());
+        const auto response_size = receive_response(client);
+
+        std::string batch{};
+        for (std::size_t i = 0; i < pipeline_depth; i++) {
+            batch += request;
+        }
+
+        char buffer[64 * 1024];
+        std::size_t requests = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < min_duration) {
+            client.send(batch.data(), batch.size());
+
+            for (std::size_t n = 0; n < response_size * pipeline_depth;) {
+                const auto size_read = client.receive(buffer, sizeof(buffer));
+                if (size_read == 0) {
+                    throw std::runtime_error{"connection closed"};
+                }
+                n += size_read;
+            }
+
+            requests += pipeline_depth;
+        }
+
+        report(name, requests, std::chrono::steady_clock::now() - start);
+    }
+
+    // Sends `request` on a new connection each time, which the server closes after refusing it.
+    void one_per_connection(const char* name, std::uint16_t port, std::string_view request) {
+        if (!mio::bench::enabled(name)) {
+            return;
+        }
+
+        char buffer[4096];
+        std::size_t requests = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < min_duration) {
+            auto client = connect(port);
+            client.send(request.data(), request.size());
+
+            while (client.receive(buffer, sizeof(buffer)) > 0) {
+            }
+
+            requests++;
+        }
+
+        report(name, requests, std::chrono::steady_clock::now() - start);
+    }
+} // namespace
+
+void bench_invalid() {
+    if (!mio::bench::any_enabled("invalid/")) {
+        return;
+    }
+
+    const auto port = start_server();
+
+    pipelined("invalid/pipelined/valid", port, "GET /users/1 HTTP/1.1\r\nconnection: keep-alive\r\n\r\n");
+    pipelined("invalid/pipelined/bad_escape", port, "GET /users/%zz HTTP/1.1\r\nconnection: keep-alive\r\n\r\n");
+
+    one_per_connection("invalid/connection/valid", port, "GET /users/1 HTTP/1.1\r\n\r\n");
+    one_per_connection("invalid/connection/bad_request_line", port, "GET /users/1 HTTP/1.1 x\r\n\r\n");
+    one_per_connection("invalid/connection/bad_content_length", port, "GET /users/1 HTTP/1.1\r\ncontent-length: x\r\n\r\n");
+    one_per_connection("invalid/connection/bad_version", port, "GET /users/1 HTTP/2.0\r\n\r\n");
+}
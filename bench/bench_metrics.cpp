@@ -0,0 +1,58 @@
+#include "mio/metrics.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "mio/router.hpp"
+
+#include "bench.hpp"
+
+void bench_metrics() {
+    using namespace std::chrono_literals;
+
+    if (!mio::bench::any_enabled("metrics/")) {
+        return;
+    }
+
+    mio::metrics m{};
+
+    const mio::route users{{}, {}, "/users/:id"};
+    const auto get = mio::metrics::method_index("GET");
+
+    // What a connection records per request, besides reading the clock.
+    {
+        mio::metrics::recorder recorder{m};
+        mio::bench::run("metrics/record_request", [&] {
+            recorder.record_request(&users, get, 200, 42us);
+            recorder.record_bytes(120, 250);
+        });
+    }
+
+    // The same once every shard to be claimed is taken.
+    mio::bench::run("metrics/record_request_shared", [&] {
+        m.record_request(&users, get, 200, 42us);
+        m.record_bytes(120, 250);
+    });
+
+    // The server reads it once per request, and once more when the request is not pipelined.
+    mio::bench::run("metrics/clock", [] { mio::bench::do_not_optimize(std::chrono::steady_clock::now()); });
+
+    mio::bench::run("metrics/method_index", [] { mio::bench::do_not_optimize(mio::metrics::method_index("DELETE")); });
+
+    // A scrape of 20 routes with a few statuses each.
+    std::vector<mio::route> routes(20);
+    for (std::size_t i = 0; i < routes.size(); i++) {
+        routes[i].pattern = "/api/v1/resource" + std::to_string(i) + "/:id";
+        for (const auto status : {200, 304, 404, 500}) {
+            m.record_request(&routes[i], get, status, 1ms);
+        }
+    }
+
+    std::string text{};
+    mio::bench::run("metrics/scrape_20_routes", [&] {
+        text.clear();
+        m.write_prometheus(text);
+        mio::bench::do_not_optimize(text);
+    });
+}
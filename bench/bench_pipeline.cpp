@@ -0,0 +1,121 @@
+#include "mio/application.hpp"
+#include "mio/http_request.hpp"
+#include "mio/http_response.hpp"
+#include "mio/http_server.hpp"
+#include "mio/sockets/socket.hpp"
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include "bench.hpp"
+
+namespace {
+    // Requests per connection. Their responses must fit in the socket buffer, since nothing reads them until the
+    // connection is done.
+    constexpr std::size_t batch_size = 64;
+
+    class application : public mio::application_base {
+    public:
+        application() {
+            get_router().get("/users/:id", [](mio::http_request& req) { return mio::http_response{200, std::string{req.param("id").value_or("")}}; });
+            get_router().post("/users", [](mio::http_request& req) { return mio::http_response{201, std::string{req.form("name").value_or("")}}; });
+        }
+    };
+
+    // Pushes batches of pipelined requests through http_server::serve() over a socket pair, all on this thread, and
+    // prints the time per request.
+    void serve(std::string_view name, mio::http_server& server, std::string_view request) {
+        if (!mio::bench::enabled(name)) {
+            return;
+        }
+
+        std::string input{};
+        for (std::size_t i = 0; i < batch_size; i++) {
+            input += request;
+        }
+
+        char buffer[64 * 1024];
+        const auto run_batch = [&] {
+            auto [client, server_end] = mio::sockets::socket::pair();
+
+            client.send(input.data(), input.size());
+            client.shutdown(mio::sockets::shutdown_type::send);
+
+            server.serve(std::move(server_end));
+
+            while (client.receive(buffer, sizeof(buffer)) > 0) {
+            }
+        };
+
+        // Warm up.
+        for (int i = 0; i < 10; i++) {
+            run_batch();
+        }
+
+        using clock = std::chrono::steady_clock;
+
+        std::uint64_t batches = 0;
+        const auto start = clock::now();
+        while (clock::now() - start < std::chrono::milliseconds{500}) {
+            run_batch();
+            batches++;
+        }
+        const auto elapsed = clock::now() - start;
+
+        const auto requests = batches * batch_size;
+        mio::bench::report(name, std::chrono::duration<double, std::nano>{elapsed}.count() / static_cast<double>(requests), "ns/req", requests);
+    }
+} // namespace
+
+void bench_pipeline() {
+    if (!mio::bench::any_enabled("pipeline/")) {
+        return;
+    }
+
+    mio::http_server server{std::make_unique<application>()};
+
+    serve("pipeline/get", server,
+          "GET /users/1234 HTTP/1.1\r\n"
+          "host: localhost\r\n"
+          "connection: keep-alive\r\n"
+          "\r\n");
+
+    serve("pipeline/get_typical_headers", server,
+          "GET /users/1234 HTTP/1.1\r\n"
+          "Host: api.example.com\r\n"
+          "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/115.0\r\n"
+          "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+          "Accept-Language: en-US,en;q=0.5\r\n"
+          "Accept-Encoding: gzip, deflate, br\r\n"
+          "Connection: keep-alive\r\n"
+          "Cookie: session=5f2b1c0e9d8a7b6c5d4e3f2a1b0c9d8e; theme=dark\r\n"
+          "\r\n");
+
+    // The same with metrics recorded, to compare against pipeline/get.
+    mio::http_server_options options{};
+    options.metrics_path = "/metrics";
+
+    mio::http_server metered{std::make_unique<application>(), options};
+
+    serve("pipeline/get_metrics", metered,
+          "GET /users/1234 HTTP/1.1\r\n"
+          "host: localhost\r\n"
+          "connection: keep-alive\r\n"
+          "\r\n");
+
+    serve("pipeline/post_form", server,
+          "POST /users HTTP/1.1\r\n"
+          "host: localhost\r\n"
+          "connection: keep-alive\r\n"
+          "content-type: application/x-www-form-urlencoded\r\n"
+          "content-length: 22\r\n"
+          "\r\n"
+          "name=mio&email=a%40b.c");
+
+    serve("pipeline/bad_escape", server,
+          "GET /users/%zz HTTP/1.1\r\n"
+          "host: localhost\r\n"
+          "connection: keep-alive\r\n"
+          "\r\n");
+}
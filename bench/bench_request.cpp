@@ -0,0 +1,56 @@
+#include "mio/http1/request.hpp"
+
+#include <string>
+
+#include "bench.hpp"
+
+namespace {
+    void parse(std::string_view name, std::string_view input) {
+        mio::http1::header headers[100];
+
+        mio::bench::run(name, [&] {
+            mio::http1::request req{};
+            std::size_t header_size;
+
+            const auto result = mio::http1::parse_request(req, headers, input, header_size);
+            mio::bench::do_not_optimize(result);
+            mio::bench::do_not_optimize(req);
+        });
+    }
+} // namespace
+
+void bench_request() {
+    if (!mio::bench::any_enabled("parse_request/")) {
+        return;
+    }
+
+    parse("parse_request/small",
+          "GET / HTTP/1.1\r\n"
+          "Host: example.com\r\n"
+          "\r\n");
+
+    // What a browser sends for a page.
+    parse("parse_request/typical",
+          "GET /api/v1/users/1234/repositories?page=2&per_page=50 HTTP/1.1\r\n"
+          "Host: api.example.com\r\n"
+          "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/115.0\r\n"
+          "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+          "Accept-Language: en-US,en;q=0.5\r\n"
+          "Accept-Encoding: gzip, deflate, br\r\n"
+          "Referer: https://example.com/users/1234\r\n"
+          "Connection: keep-alive\r\n"
+          "Cookie: session=5f2b1c0e9d8a7b6c5d4e3f2a1b0c9d8e; theme=dark\r\n"
+          "\r\n");
+
+    // Many headers and a long cookie, close to what proxies forward.
+    std::string large =
+        "POST /api/v1/upload/batch/2024/archive.tar.gz?overwrite=true&notify=false HTTP/1.1\r\n"
+        "Host: api.example.com\r\n"
+        "Cookie: " + std::string(2048, 'c') + "\r\n";
+    for (int i = 0; i < 40; i++) {
+        large += "X-Forwarded-Header-" + std::to_string(i) + ": value-" + std::to_string(i) + "-0123456789abcdef\r\n";
+    }
+    large += "\r\n";
+
+    parse("parse_request/large", large);
+}
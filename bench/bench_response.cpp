@@ -0,0 +1,52 @@
+#include "mio/http1/response.hpp"
+
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace {
+    void write(std::string_view name, std::size_t body_size, bool head_only) {
+        mio::http1::header headers[] = {
+            {"content-type", "application/json; charset=utf-8"},
+            {"cache-control", "no-store"},
+            {"date", "Sun, 06 Nov 1994 08:49:37 GMT"},
+            {"server", "mio"},
+            {"connection", "keep-alive"},
+        };
+
+        const std::vector<std::byte> body(body_size, std::byte{'x'});
+
+        const mio::http1::response res{
+            .http_version = "HTTP/1.1",
+            .status_code = 200,
+            .headers = headers,
+            .body = body,
+        };
+
+        // Reused like the connection's output, so only formatting is measured.
+        std::pmr::string out{};
+        out.reserve(body_size + 1024);
+
+        mio::bench::run(name, [&] {
+            out.clear();
+            if (head_only) {
+                mio::http1::write_response_head(out, res);
+            } else {
+                mio::http1::write_response(out, res);
+            }
+            mio::bench::do_not_optimize(out.data());
+        });
+    }
+} // namespace
+
+void bench_response() {
+    if (!mio::bench::any_enabled("write_response/")) {
+        return;
+    }
+
+    write("write_response/head", 0, true);
+    write("write_response/small", 64, false);
+    write("write_response/4KiB", 4 * 1024, false);
+}
@@ -0,0 +1,45 @@
+#include "mio/router.hpp"
+
+#include <string>
+#include <vector>
+
+#include "mio/http_request.hpp"
+#include "mio/http_response.hpp"
+
+#include "bench.hpp"
+
+namespace {
+    mio::http_response handler(const mio::http_request&) {
+        return mio::http_response{200};
+    }
+
+    // Looks up the route inserted last among `size` routes shaped like `prefix<i>suffix`.
+    void find(const std::string& name, std::size_t size, std::string_view prefix, std::string_view suffix, std::string_view path_suffix) {
+        mio::routing_tree tree{"", std::nullopt};
+        for (std::size_t i = 0; i < size; i++) {
+            tree.insert(std::string{prefix} + std::to_string(i) + std::string{suffix}, "GET", handler);
+        }
+
+        const auto path = std::string{prefix} + std::to_string(size - 1) + std::string{path_suffix};
+        mio::route_params params{};
+        std::string buffer(path.size(), '\0');
+
+        mio::bench::run(name, [&] {
+            params.clear();
+            mio::bench::do_not_optimize(tree.find(path, "GET", params, buffer.data()));
+        });
+    }
+} // namespace
+
+void bench_router() {
+    if (!mio::bench::any_enabled("router/")) {
+        return;
+    }
+
+    for (const std::size_t size : {10, 100, 1000}) {
+        const auto n = std::to_string(size);
+
+        find("router/static/" + n, size, "/api/v1/resource", "/items/latest", "/items/latest");
+        find("router/wildcard/" + n, size, "/api/v1/resource", "/:id/items/:item", "/1234/items/abc%20def");
+    }
+}
@@ -0,0 +1,28 @@
+#include "mio/uri.hpp"
+
+#include <string>
+
+#include "bench.hpp"
+
+void bench_uri() {
+    const std::string_view plain = "/api/v1/users/1234567890/repositories/mio/contents/src/mio/router.cpp";
+    const std::string_view escaped = "/api/v1/search/caf%C3%A9+au+lait%20%26%20croissants/page%2F2?q=a%2Bb";
+
+    char buffer[256];
+
+    mio::bench::run("decode_uri/view/plain", [&] {
+        mio::bench::do_not_optimize(mio::decode_uri(plain, true, buffer));
+    });
+
+    mio::bench::run("decode_uri/view/escaped", [&] {
+        mio::bench::do_not_optimize(mio::decode_uri(escaped, true, buffer));
+    });
+
+    mio::bench::run("decode_uri/string/plain", [&] {
+        mio::bench::do_not_optimize(mio::decode_uri(plain, true));
+    });
+
+    mio::bench::run("decode_uri/string/escaped", [&] {
+        mio::bench::do_not_optimize(mio::decode_uri(escaped, true));
+    });
+}
@@ -0,0 +1,141 @@
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#include "mio/sockets/endpoint.hpp"
+#include "mio/sockets/socket.hpp"
+
+#include "bench.hpp"
+
+namespace {
+    constexpr std::size_t total_size = std::size_t{1} << 30;
+
+    struct socket_pair {
+        mio::sockets::socket server;
+        mio::sockets::socket client;
+    };
+
+    std::optional<socket_pair> connect() {
+        mio::sockets::socket listener{mio::sockets::address_family::inet, mio::sockets::socket_type::stream};
+        listener.listen(mio::sockets::endpoint::inet("127.0.0.1", 0));
+
+        const auto address = listener.local_endpoint();
+
+        mio::sockets::socket client{mio::sockets::address_family::inet, mio::sockets::socket_type::stream};
+        if (::connect(client.descriptor(), address.data(), address.size()) < 0) {
+            return std::nullopt;
+        }
+
+        mio::sockets::endpoint peer{};
+        auto server = listener.accept(peer);
+        if (!server) {
+            return std::nullopt;
+        }
+
+        return socket_pair{std::move(*server), std::move(client)};
+    }
+
+    std::chrono::microseconds thread_cpu_time() {
+        ::rusage usage{};
+        ::getrusage(RUSAGE_THREAD, &usage);
+
+        const auto to_us = [](const ::timeval& tv) { return std::chrono::seconds{tv.tv_sec} + std::chrono::microseconds{tv.tv_usec}; };
+        return to_us(usage.ru_utime) + to_us(usage.ru_stime);
+    }
+
+    // Sends 1 GiB in `body_size` pieces from one buffer over loopback and prints the CPU time of the sending thread.
+    void send_all(const char* name, std::size_t body_size, bool zero_copy) {
+        if (!mio::bench::enabled(name)) {
+            return;
+        }
+
+        auto sockets = connect();
+        if (!sockets || (zero_copy && sockets->server.set_zero_copy(true) < 0)) {
+            std::fprintf(stderr, "%s: unsupported\n", name);
+            return;
+        }
+
+        auto& server = sockets->server;
+        auto& client = sockets->client;
+
+        std::thread reader{[&client] {
+            std::vector<std::byte> buffer(256 * 1024);
+            for (std::size_t n = 0; n < total_size;) {
+                n += client.receive(buffer.data(), buffer.size());
+            }
+        }};
+
+        const std::vector<std::byte> body(body_size, std::byte{'x'});
+
+        const auto wall_start = std::chrono::steady_clock::now();
+        const auto cpu_start = thread_cpu_time();
+
+        std::uint32_t sent = 0;
+        std::uint32_t completed = 0;
+        std::size_t copied = 0;
+
+        for (std::size_t total = 0; total < total_size;) {
+            for (std::size_t offset = 0; offset < body.size();) {
+                const ::iovec iov{const_cast<std::byte*>(body.data() + offset), body.size() - offset};
+
+                std::size_t n;
+                if (zero_copy) {
+                    const auto result = server.send_some_zero_copy(std::span{&iov, 1});
+                    if (!result) {
+                        server.wait_error_queue(); // Over the optmem limit until notifications are read.
+                        n = 0;
+                    } else if ((n = *result) > 0) {
+                        sent++;
+                    }
+
+                    while (const auto completion = server.receive_zero_copy_completion()) {
+                        completed += completion->last - completion->first + 1;
+                        copied += completion->copied ? completion->last - completion->first + 1 : 0;
+                    }
+                } else {
+                    n = server.send_some(std::span{&iov, 1});
+                }
+
+                if (n == 0) {
+                    server.wait_writable();
+                }
+
+                offset += n;
+                total += n;
+            }
+        }
+
+        while (zero_copy && completed != sent) {
+            server.wait_error_queue();
+            while (const auto completion = server.receive_zero_copy_completion()) {
+                completed += completion->last - completion->first + 1;
+                copied += completion->copied ? completion->last - completion->first + 1 : 0;
+            }
+        }
+
+        const auto cpu = std::chrono::duration<double, std::milli>{thread_cpu_time() - cpu_start}.count();
+        const auto wall = std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - wall_start}.count();
+
+        reader.join();
+
+        mio::bench::report(std::string{name} + "/cpu", cpu, "ms/GiB");
+        mio::bench::report(std::string{name} + "/wall", wall, "ms/GiB");
+        if (zero_copy) {
+            // Sends the kernel reported as copied after all, out of `sent`.
+            mio::bench::report(std::string{name} + "/copied", static_cast<double>(copied), "sends", sent);
+        }
+    }
+} // namespace
+
+void bench_zero_copy() {
+    send_all("zero_copy/send/256KiB/copy", 256 * 1024, false);
+    send_all("zero_copy/send/256KiB/zero_copy", 256 * 1024, true);
+    send_all("zero_copy/send/4MiB/copy", 4 * 1024 * 1024, false);
+    send_all("zero_copy/send/4MiB/zero_copy", 4 * 1024 * 1024, true);
+}
@@ -0,0 +1,404 @@
+// Replays a mix of requests against a running server over keep-alive connections and reports throughput and latency.
+//
+//   mio_loadgen <scenario> [key=value...]
+//
+// A scenario is a text file of `key value` lines (see bench/scenarios); key=value arguments override them.
+//
+//   host 127.0.0.1
+//   port 3000
+//   connections 16   keep-alive connections, one thread each
+//   pipeline 1       requests in flight per connection
+//   rate 20000       requests per second over all connections; 0 sends the next request as soon as a response arrives
+//   warmup 2         seconds of traffic before measuring
+//   duration 10      seconds measured
+//   request <weight> <method> <path> [<content-type> <body>]   any method but HEAD
+//
+// With a rate, each request has a time at which it is due, and its latency is measured from that time rather than
+// from when it was sent. A stalled server then shows up in the latency of every request queued behind the stall,
+// instead of silently lowering the number of requests sent (the coordinated-omission correction of wrk2).
+// Without a rate the latencies are those of a closed loop and are reported as uncorrected.
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "mio/sockets/endpoint.hpp"
+#include "mio/sockets/socket.hpp"
+#include "mio/util/hdr_histogram.hpp"
+
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    struct request_spec {
+        std::size_t weight;
+        std::string method;
+        std::string path;
+        std::string content_type;
+        std::string body;
+    };
+
+    struct config {
+        std::string host = "127.0.0.1";
+        std::uint16_t port = 3000;
+        std::size_t connections = 16;
+        std::size_t pipeline = 1;
+        double rate = 0;
+        double warmup = 2;
+        double duration = 10;
+        std::vector<request_spec> requests;
+    };
+
+    struct connection_result {
+        mio::util::hdr_histogram latency{};
+        std::uint64_t responses = 0;
+        std::uint64_t errors = 0;      // Responses with a status of 400 or above.
+        std::uint64_t reconnects = 0;  // Connections closed by the server; their requests in flight are lost.
+    };
+
+    template <typename Int>
+    Int to_number(std::string_view s) {
+        Int value{};
+        if (const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value); ec != std::errc{} || ptr != s.data() + s.size()) {
+            throw std::runtime_error{"not a number: " + std::string{s}};
+        }
+        return value;
+    }
+
+    double to_double(const std::string& s) {
+        std::size_t pos;
+        const auto value = std::stod(s, &pos);
+        if (pos != s.size()) {
+            throw std::runtime_error{"not a number: " + s};
+        }
+        return value;
+    }
+
+    void set(config& c, const std::string& key, const std::string& value) {
+        if (key == "host") {
+            c.host = value;
+        } else if (key == "port") {
+            c.port = to_number<std::uint16_t>(value);
+        } else if (key == "connections") {
+            c.connections = to_number<std::size_t>(value);
+        } else if (key == "pipeline") {
+            c.pipeline = to_number<std::size_t>(value);
+        } else if (key == "rate") {
+            c.rate = to_double(value);
+        } else if (key == "warmup") {
+            c.warmup = to_double(value);
+        } else if (key == "duration") {
+            c.duration = to_double(value);
+        } else if (key == "request") {
+            std::istringstream in{value};
+
+            request_spec r{};
+            in >> r.weight >> r.method >> r.path >> r.content_type;
+            std::getline(in >> std::ws, r.body);
+
+            if (!in.eof() && in.fail()) {
+                throw std::runtime_error{"invalid request: " + value};
+            }
+            if (r.weight == 0 || r.method.empty() || r.path.empty()) {
+                throw std::runtime_error{"invalid request: " + value};
+            }
+            // Responses are framed by their content-length, which a response to HEAD has without the body.
+            if (r.method == "HEAD") {
+                throw std::runtime_error{"HEAD requests are not supported: " + value};
+            }
+
+            c.requests.push_back(std::move(r));
+        } else {
+            throw std::runtime_error{"unknown key: " + key};
+        }
+    }
+
+    config load(const char* path) {
+        std::ifstream file{path};
+        if (!file) {
+            throw std::runtime_error{"cannot open " + std::string{path}};
+        }
+
+        config c{};
+        for (std::string line; std::getline(file, line);) {
+            if (const auto comment = line.find('#'); comment != std::string::npos) {
+                line.erase(comment);
+            }
+
+            std::istringstream in{line};
+            std::string key{};
+            if (!(in >> key)) {
+                continue;
+            }
+
+            std::string value{};
+            std::getline(in >> std::ws, value);
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+                value.pop_back();
+            }
+
+            set(c, key, value);
+        }
+
+        return c;
+    }
+
+    std::string serialize(const config& c, const request_spec& r) {
+        std::string s = r.method + " " + r.path + " HTTP/1.1\r\n";
+        s += "host: " + c.host + ":" + std::to_string(c.port) + "\r\n";
+        s += "connection: keep-alive\r\n";
+
+        if (!r.content_type.empty()) {
+            s += "content-type: " + r.content_type + "\r\n";
+        }
+        if (!r.body.empty() || !r.content_type.empty()) {
+            s += "content-length: " + std::to_string(r.body.size()) + "\r\n";
+        }
+
+        s += "\r\n";
+        s += r.body;
+        return s;
+    }
+
+    // Every request repeated by its weight, shuffled so that the mix is even over short spans.
+    std::vector<std::size_t> make_order(const config& c) {
+        std::vector<std::size_t> order{};
+        for (std::size_t i = 0; i < c.requests.size(); i++) {
+            order.insert(std::end(order), c.requests[i].weight, i);
+        }
+
+        std::shuffle(std::begin(order), std::end(order), std::mt19937{1});
+        return order;
+    }
+
+    mio::sockets::socket connect(const config& c) {
+        const auto address = mio::sockets::endpoint::inet(c.host, c.port);
+
+        // The server may still be starting.
+        for (int retry = 0;; retry++) {
+            mio::sockets::socket client{address.family(), mio::sockets::socket_type::stream};
+            if (::connect(client.descriptor(), address.data(), address.size()) == 0) {
+                client.set_no_delay(true);
+                return client;
+            }
+
+            if (retry == 500) {
+                throw std::system_error{errno, std::generic_category()};
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+    }
+
+    bool equals_lowercase(std::string_view s, std::string_view lower) noexcept {
+        return s.size() == lower.size() && std::equal(std::begin(s), std::end(s), std::begin(lower), [](char a, char b) {
+                   return (('A' <= a && a <= 'Z') ? a | 0x20 : a) == b;
+               });
+    }
+
+    struct response_frame {
+        std::size_t size;
+        int status;
+    };
+
+    // Finds the end of the first response in `input`, if it is complete. Responses must have a content-length.
+    std::optional<response_frame> parse_response(std::string_view input) {
+        const auto head_end = input.find("\r\n\r\n");
+        if (head_end == std::string_view::npos) {
+            return std::nullopt;
+        }
+
+        // "HTTP/1.1 200 OK"
+        if (input.size() < 12) {
+            throw std::runtime_error{"invalid response"};
+        }
+        const auto status = to_number<int>(input.substr(9, 3));
+
+        std::optional<std::size_t> content_length{};
+        for (auto pos = input.find("\r\n") + 2; pos < head_end;) {
+            const auto line_end = input.find("\r\n", pos);
+            const auto line = input.substr(pos, line_end - pos);
+            pos = line_end + 2;
+
+            const auto colon = line.find(':');
+            if (colon != std::string_view::npos && equals_lowercase(line.substr(0, colon), "content-length")) {
+                auto value = line.substr(colon + 1);
+                value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+                content_length = to_number<std::size_t>(value);
+            }
+        }
+
+        if (!content_length) {
+            throw std::runtime_error{"responses without content-length are not supported"};
+        }
+
+        const auto size = head_end + 4 + *content_length;
+        if (input.size() < size) {
+            return std::nullopt;
+        }
+
+        return response_frame{size, status};
+    }
+
+    void run_connection(const config& c, const std::vector<std::string>& requests, const std::vector<std::size_t>& order, std::size_t id,
+                        clock::time_point start, clock::time_point measure_start, clock::time_point end, connection_result& result) {
+        const bool open_loop = c.rate > 0;
+        const auto interval = open_loop ? std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>{static_cast<double>(c.connections) / c.rate}) : clock::duration{};
+
+        auto client = connect(c);
+
+        // When each request in flight was due, oldest first.
+        std::deque<clock::time_point> in_flight{};
+        std::string input{};
+        char buffer[64 * 1024];
+
+        // Connections are spread evenly over the first interval.
+        auto next = start + interval * static_cast<clock::rep>(id) / static_cast<clock::rep>(c.connections);
+        std::size_t k = id * order.size() / c.connections;
+
+        for (;;) {
+            auto now = clock::now();
+            if (now >= end) {
+                break;
+            }
+
+            while (in_flight.size() < c.pipeline && (!open_loop || next <= now)) {
+                const auto& request = requests[order[k++ % order.size()]];
+                client.send(request.data(), request.size());
+
+                in_flight.push_back(open_loop ? next : now);
+                next += interval;
+            }
+
+            // Wait for a response, or until the next request is due.
+            const auto wake = (open_loop && in_flight.size() < c.pipeline) ? std::min(next, end) : end;
+            const auto timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(std::max(wake - now, clock::duration{}));
+            const ::timespec ts{static_cast<std::time_t>(timeout.count() / 1'000'000'000), static_cast<long>(timeout.count() % 1'000'000'000)};
+
+            ::pollfd pfd{client.descriptor(), POLLIN, 0};
+            if (::ppoll(&pfd, 1, &ts, nullptr) <= 0) {
+                continue;
+            }
+
+            const auto n = ::recv(client.descriptor(), buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+                continue;
+            }
+            if (n <= 0) {
+                // Closed by the server, e.g. after an error response.
+                result.reconnects++;
+                in_flight.clear();
+                input.clear();
+                client = connect(c);
+                continue;
+            }
+
+            input.append(buffer, static_cast<std::size_t>(n));
+            now = clock::now();
+
+            std::size_t consumed = 0;
+            while (const auto frame = parse_response(std::string_view{input}.substr(consumed))) {
+                if (in_flight.empty()) {
+                    throw std::runtime_error{"unexpected response"};
+                }
+
+                if (now >= measure_start) {
+                    result.latency.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - in_flight.front()).count()));
+                    result.responses++;
+                    result.errors += frame->status >= 400 ? 1 : 0;
+                }
+
+                in_flight.pop_front();
+                consumed += frame->size;
+            }
+            input.erase(0, consumed);
+        }
+    }
+
+    void print_latency(const mio::util::hdr_histogram& h) {
+        const auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+        std::printf("latency     mean %.1f us, p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+                    h.mean() / 1000.0, us(h.percentile(50)), us(h.percentile(90)), us(h.percentile(99)), us(h.percentile(99.9)), us(h.max()));
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <scenario> [key=value...]\n", argv[0]);
+        return 1;
+    }
+
+    try {
+        auto c = load(argv[1]);
+        for (int i = 2; i < argc; i++) {
+            const std::string_view arg = argv[i];
+            const auto eq = arg.find('=');
+            if (eq == std::string_view::npos) {
+                throw std::runtime_error{"expected key=value: " + std::string{arg}};
+            }
+            set(c, std::string{arg.substr(0, eq)}, std::string{arg.substr(eq + 1)});
+        }
+
+        if (c.requests.empty() || c.connections == 0 || c.pipeline == 0) {
+            throw std::runtime_error{"a scenario needs requests, connections and pipeline"};
+        }
+
+        std::vector<std::string> requests{};
+        for (const auto& r : c.requests) {
+            requests.push_back(serialize(c, r));
+        }
+        const auto order = make_order(c);
+
+        const auto start = clock::now() + std::chrono::milliseconds{100};
+        const auto measure_start = start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>{c.warmup});
+        const auto end = measure_start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>{c.duration});
+
+        std::vector<connection_result> results(c.connections);
+        std::vector<std::thread> threads{};
+        for (std::size_t i = 0; i < c.connections; i++) {
+            threads.emplace_back(run_connection, std::cref(c), std::cref(requests), std::cref(order), i, start, measure_start, end, std::ref(results[i]));
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        connection_result total{};
+        for (const auto& r : results) {
+            total.latency.merge(r.latency);
+            total.responses += r.responses;
+            total.errors += r.errors;
+            total.reconnects += r.reconnects;
+        }
+
+        std::printf("scenario    %s\n", argv[1]);
+        if (c.rate > 0) {
+            std::printf("load        %zu connections, pipeline %zu, %.0f req/s offered (latency corrected for coordinated omission)\n", c.connections, c.pipeline, c.rate);
+        } else {
+            std::printf("load        %zu connections, pipeline %zu, closed loop (latency uncorrected)\n", c.connections, c.pipeline);
+        }
+        std::printf("requests    %llu in %.2f s, %.0f req/s, %llu errors, %llu reconnects\n",
+                    static_cast<unsigned long long>(total.responses), c.duration, static_cast<double>(total.responses) / c.duration,
+                    static_cast<unsigned long long>(total.errors), static_cast<unsigned long long>(total.reconnects));
+        print_latency(total.latency);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "mio_loadgen: %s\n", e.what());
+        return 1;
+    }
+}
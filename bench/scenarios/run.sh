@@ -0,0 +1,21 @@
+#!/bin/sh
+# Starts an example server, replays a scenario against it with mio_loadgen and stops the server.
+#
+#   bench/scenarios/run.sh <build-dir> <scenario> [key=value...]
+#   bench/scenarios/run.sh build bench/scenarios/simple_http/static.txt rate=50000
+#
+# The scenario's directory names the example. Run from the repository root, where the examples find their files.
+set -eu
+
+build=$1
+scenario=$2
+shift 2
+
+example=$(basename "$(dirname "$scenario")")
+
+"$build/examples/$example" > /dev/null &
+server=$!
+trap 'kill $server' EXIT
+
+# mio_loadgen retries until the server listens.
+"$build/bin/mio_loadgen" "$scenario" "$@"
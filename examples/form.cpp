@@ -3,12 +3,13 @@
 #include <iostream>
 
 #include "mio/application.hpp"
+#include "mio/bodies/multipart.hpp"
 #include "mio/middlewares/static.hpp"
 
 class application : public mio::application_base {
 public:
     application() {
-        use(mio::middlewares::static_{"./examples/form"});
+        get_router().mount("/", mio::middlewares::static_{"./examples/form"});
 
         get_router().post("/", [](mio::http_request& req) {
             std::cout << "name: " << req.form("name").value_or("") << std::endl;
@@ -16,6 +17,30 @@ public:
 
             return mio::http_response{200, "OK"};
         });
+
+        // The body is read from the connection as it is parsed, so large uploads run in constant memory.
+        get_router().post(
+            "/upload",
+            [](mio::http_request& req) {
+                auto form = mio::bodies::parse_multipart(req);
+
+                std::cout << "name: " << form.field("name").value_or("") << std::endl;
+                for (const auto& file : form.files()) {
+                    std::cout << "file: " << file.filename() << " (" << file.size() << " bytes)" << std::endl;
+                }
+
+                return mio::http_response{200, "OK"};
+            },
+            {.stream_body = true, .max_body_size = 64 * 1024 * 1024});
+
+        // The body goes from the socket into a temporary file without passing through the process.
+        get_router().post(
+            "/artifacts",
+            [](mio::http_request& req) {
+                std::cout << "artifact: " << req.body_file_size() << " bytes" << std::endl;
+                return mio::http_response{200, "OK"};
+            },
+            {.max_body_size = 1024 * 1024 * 1024, .body_file_directory = "/tmp"});
     }
 };
 
@@ -2,11 +2,13 @@
 
 #include "mio/application.hpp"
 #include "mio/middlewares/static.hpp"
+#include "mio/prebuilt_response.hpp"
 
 class application : public mio::application_base {
 public:
     application() {
-        use(mio::middlewares::static_{"./examples/simple_http"});
+        get_router().get("/healthz", mio::prebuilt(mio::http_response::json(200, R"({"status":"ok"})")));
+        get_router().mount("/", mio::middlewares::static_{"./examples/simple_http"});
     }
 };
 
@@ -7,18 +7,53 @@ namespace mio {
     class http_response;
     class http_request;
     class router;
+    class application_base;
 
+    // Runs after the request has been handled.
     using middleware = std::function<void(http_request&, http_response&)>;
 
+    // Runs before routing. Returning a response short-circuits the remaining before middlewares and the handler.
+    using before_middleware = std::function<std::optional<http_response>(http_request&)>;
+
+    // The rest of the chain as seen by an around middleware.
+    class next_handler {
+        friend class application_base;
+
+    private:
+        next_handler(application_base& app, std::size_t index) noexcept
+            : app_(app)
+            , index_(index) {
+        }
+
+    public:
+        http_response operator()(http_request& req) const;
+
+    private:
+        application_base& app_;
+        std::size_t index_;
+    };
+
+    // Wraps the rest of the chain. Not calling `next` short-circuits it.
+    using around_middleware = std::function<http_response(http_request&, const next_handler&)>;
+
     class application {
     public:
         application() = default;
         virtual ~application() noexcept = default;
 
+        // Called once the headers have been parsed, before the body is read (and before `100 Continue` is sent).
+        // Fills in the options of the route; returning a response rejects the request without reading its body.
+        virtual std::optional<http_response> on_headers(http_request& req, route_options& options);
+
         virtual http_response on_request(http_request& req) = 0;
 
+        // Answers what a handler threw, save for a request_error_exception, which goes to on_request_error().
         virtual http_response on_error(const std::exception& e) noexcept = 0;
         virtual http_response on_unknown_error() noexcept = 0;
+
+        // Answers a request that cannot be handled: unparsable, too large, or of an unsupported HTTP version.
+        // The connection is closed after the response when the error is in the framing of the request.
+        virtual http_response on_request_error(request_error error) noexcept;
     };
 
     class application_base : public application {
@@ -26,6 +61,7 @@ namespace mio {
         application_base() = default;
         virtual ~application_base() noexcept = default;
 
+        virtual std::optional<http_response> on_headers(http_request& req, route_options& options) override;
         virtual http_response on_request(http_request& req) override;
         virtual http_response on_routing_not_found(http_request& req);
 
@@ -40,11 +76,42 @@ namespace mio {
             return router_;
         }
 
+        // The request passes through the around middlewares (outermost first), then the before middlewares,
+        // the router and the after middlewares. A prefix restricts a middleware to the paths under it.
         void use(middleware&& middleware);
 
+        void before(before_middleware&& middleware);
+        void before(std::string_view prefix, before_middleware&& middleware);
+
+        // Runs in on_headers(), where the body is not available yet. Returning a response rejects the request
+        // before its body is received.
+        void before_body(before_middleware&& middleware);
+        void before_body(std::string_view prefix, before_middleware&& middleware);
+
+        void after(middleware&& middleware);
+        void after(std::string_view prefix, middleware&& middleware);
+
+        void around(around_middleware&& middleware);
+        void around(std::string_view prefix, around_middleware&& middleware);
+
+    private:
+        friend class next_handler;
+
+        template <typename Middleware>
+        struct scoped_middleware {
+            std::string prefix;
+            Middleware middleware;
+        };
+
+        http_response dispatch(http_request& req, std::size_t index);
+        http_response handle(http_request& req);
+
     private:
         router router_;
-        std::vector<middleware> middlewares_;
+        std::vector<scoped_middleware<before_middleware>> before_body_middlewares_;
+        std::vector<scoped_middleware<before_middleware>> before_middlewares_;
+        std::vector<scoped_middleware<middleware>> after_middlewares_;
+        std::vector<scoped_middleware<around_middleware>> around_middlewares_;
 
     private:
         // Uncopyable and unmovable
@@ -0,0 +1,211 @@
+#ifndef INCLUDE_mio_bodies_multipart_hpp
+#define INCLUDE_mio_bodies_multipart_hpp
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../http_headers.hpp"
+#include "../util/unique_fd.hpp"
+
+namespace mio {
+    class http_request;
+} // namespace mio
+
+namespace mio::bodies {
+    // Returns the boundary parameter of a multipart/form-data content type.
+    [[nodiscard]] std::optional<std::string_view> multipart_boundary(const http_headers& headers);
+
+    // Receives the parts of a multipart body as the parser finds them.
+    class multipart_handler {
+    public:
+        multipart_handler() = default;
+        virtual ~multipart_handler() noexcept = default;
+
+        virtual void on_part_begin(const http_headers& headers) = 0;
+        virtual void on_part_data(std::span<const std::byte> data) = 0;
+        virtual void on_part_end() = 0;
+
+    protected:
+        multipart_handler(const multipart_handler&) = default;
+        multipart_handler(multipart_handler&&) = default;
+
+        multipart_handler& operator=(const multipart_handler&) = default;
+        multipart_handler& operator=(multipart_handler&&) = default;
+    };
+
+    // Incremental multipart parser (RFC 2046).
+    // The body can be fed in chunks of any size; only a delimiter's worth of bytes and one part header block are
+    // buffered, so memory use does not depend on the body size. Delimiters are found with Boyer-Moore-Horspool.
+    class multipart_parser {
+    public:
+        static constexpr std::size_t max_part_header_size = 8192;
+
+        multipart_parser(std::string_view boundary, multipart_handler& handler);
+        ~multipart_parser() noexcept = default;
+
+        // Feeds the next chunk of the body. Throws request_error_exception on a malformed body.
+        void feed(std::span<const std::byte> data);
+
+        void feed(std::string_view data) {
+            feed(std::as_bytes(std::span{data}));
+        }
+
+        // True once the close delimiter has been seen.
+        [[nodiscard]] bool done() const noexcept {
+            return state_ == state::epilogue;
+        }
+
+    private:
+        enum class state {
+            preamble,
+            delimiter_tail,
+            part_headers,
+            part_body,
+            epilogue,
+        };
+
+        std::size_t find_delimiter(std::string_view haystack) const noexcept;
+        std::size_t feed_body(std::string_view data);
+        std::size_t feed_delimiter_tail(std::string_view data);
+        std::size_t feed_part_headers(std::string_view data);
+        void emit(std::string_view data);
+        void end_body();
+
+    private:
+        multipart_handler& handler_;
+        std::string delimiter_; // "\r\n--" boundary
+        std::array<std::size_t, 256> skip_;
+        state state_;
+        std::string carry_;
+        std::string header_buffer_;
+    };
+
+    // A file part spooled to a temporary file, which is removed on destruction unless persisted.
+    class multipart_file {
+    public:
+        multipart_file(std::string name, std::string filename, std::string content_type, std::filesystem::path path);
+        ~multipart_file() noexcept;
+
+        // Uncopyable and movable
+        multipart_file(const multipart_file&) = delete;
+        multipart_file(multipart_file&& other) noexcept;
+
+        multipart_file& operator=(const multipart_file&) = delete;
+        multipart_file& operator=(multipart_file&& other) noexcept;
+
+        [[nodiscard]] const std::string& name() const noexcept {
+            return name_;
+        }
+
+        [[nodiscard]] const std::string& filename() const noexcept {
+            return filename_;
+        }
+
+        [[nodiscard]] const std::string& content_type() const noexcept {
+            return content_type_;
+        }
+
+        [[nodiscard]] const std::filesystem::path& path() const noexcept {
+            return path_;
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept {
+            return size_;
+        }
+
+        // Moves the file to `to`; it is no longer removed on destruction.
+        void persist(const std::filesystem::path& to);
+
+    private:
+        friend class multipart_form;
+
+        std::string name_;
+        std::string filename_;
+        std::string content_type_;
+        std::filesystem::path path_;
+        std::size_t size_;
+    };
+
+    struct multipart_part {
+        std::string_view name;
+        std::string_view filename;
+        std::string_view content_type;
+    };
+
+    using multipart_sink = std::function<void(std::span<const std::byte>)>;
+
+    struct multipart_options {
+        // Text fields larger than this are rejected as payload_too_large.
+        std::size_t max_field_size = 64 * 1024;
+
+        // Bodies with more text fields or file parts than these, or whose text fields add up to more, are rejected
+        // likewise.
+        std::size_t max_fields = 1000;
+        std::size_t max_total_field_size = 1024 * 1024;
+        std::size_t max_files = 100;
+
+        // Directory for spooled file parts; the system temporary directory if empty.
+        std::filesystem::path temp_directory{};
+
+        // If set, receives every file part instead of a temporary file. Called at the beginning of the part.
+        std::function<multipart_sink(const multipart_part&)> open_file{};
+    };
+
+    // A multipart/form-data body: text fields in memory and file parts streamed to temporary files or sinks.
+    class multipart_form : public multipart_handler {
+    public:
+        explicit multipart_form(multipart_options options = {});
+        ~multipart_form() noexcept override;
+
+        // Uncopyable and movable
+        multipart_form(const multipart_form&) = delete;
+        multipart_form(multipart_form&&) = default;
+
+        multipart_form& operator=(const multipart_form&) = delete;
+        multipart_form& operator=(multipart_form&&) = default;
+
+        [[nodiscard]] std::optional<std::string_view> field(std::string_view name) const noexcept;
+
+        [[nodiscard]] const std::vector<std::pair<std::string, std::string>>& fields() const noexcept {
+            return fields_;
+        }
+
+        [[nodiscard]] const multipart_file* file(std::string_view name) const noexcept;
+
+        [[nodiscard]] std::vector<multipart_file>& files() noexcept {
+            return files_;
+        }
+
+        void on_part_begin(const http_headers& headers) override;
+        void on_part_data(std::span<const std::byte> data) override;
+        void on_part_end() override;
+
+    private:
+        enum class part_kind {
+            field,
+            temp_file,
+            sink,
+        };
+
+        multipart_options options_;
+        std::vector<std::pair<std::string, std::string>> fields_;
+        std::vector<multipart_file> files_;
+
+        part_kind kind_;
+        util::unique_fd fd_;
+        multipart_sink sink_;
+        std::size_t file_count_; // Including the parts given to sinks.
+        std::size_t total_field_size_;
+    };
+
+    // Parses a multipart/form-data request body, reading it from the connection if it is streamed.
+    [[nodiscard]] multipart_form parse_multipart(http_request& req, multipart_options options = {});
+} // namespace mio::bodies
+
+#endif // INCLUDE_mio_bodies_multipart_hpp
@@ -1,12 +1,19 @@
 #ifndef INCLUDE_mio_bodies_x_www_form_url_encoded_hpp
 #define INCLUDE_mio_bodies_x_www_form_url_encoded_hpp
 
+#include <string_view>
+#include "../request_error.hpp"
+
 namespace mio {
-    class http_request;
-}
+    class http_headers;
+    class url_encoded_fields;
+} // namespace mio
 
 namespace mio::bodies {
-    void parse_x_www_form_url_encoded(http_request& req);
-}
+    [[nodiscard]] bool is_x_www_form_url_encoded(const http_headers& headers);
+
+    // Parses `body` into `fields` unless already parsed. See url_encoded_fields::parse().
+    request_result<void> parse_x_www_form_url_encoded(std::string_view body, url_encoded_fields& fields);
+} // namespace mio::bodies
 
 #endif // INCLUDE_mio_bodies_x_www_form_url_encoded_hpp
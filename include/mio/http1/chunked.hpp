@@ -0,0 +1,62 @@
+#ifndef INCLUDE_mio_http1_chunked_hpp
+#define INCLUDE_mio_http1_chunked_hpp
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include "request.hpp"
+
+namespace mio::http1 {
+    // Incremental decoder of the chunked transfer coding (RFC 7230 4.1).
+    class chunked_decoder {
+    public:
+        static constexpr std::size_t max_line_size = 1024;
+
+        chunked_decoder() noexcept = default;
+
+        // Decodes `buffer` in place: on return its first `size` bytes are body data and `consumed` is the number
+        // of input bytes used. Returns completed once the last chunk and the trailer are read; the bytes after
+        // `consumed` then belong to the next message.
+        parse_result decode(std::span<std::byte> buffer, std::size_t& size, std::size_t& consumed) noexcept;
+
+        [[nodiscard]] bool done() const noexcept {
+            return state_ == state::done;
+        }
+
+    private:
+        enum class state {
+            size,
+            extension,
+            size_lf,
+            data,
+            data_cr,
+            data_lf,
+            trailer,
+            trailer_lf,
+            done,
+        };
+
+        state state_ = state::size;
+        std::uint64_t chunk_size_ = 0;
+        std::size_t size_digits_ = 0;
+        std::size_t line_size_ = 0;
+    };
+
+    // The last chunk and an empty trailer.
+    inline constexpr std::string_view last_chunk = "0\r\n\r\n";
+
+    inline constexpr std::size_t max_chunk_header_size = sizeof(std::size_t) * 2 + 2;
+
+    // Formats the size line of a chunk of `size` bytes into `buffer`; the data and a CRLF follow it.
+    std::string_view write_chunk_header(char (&buffer)[max_chunk_header_size], std::size_t size) noexcept;
+
+    // Appends one chunk carrying `data`. Empty data is skipped since it would end the body.
+    void write_chunk(std::pmr::string& out, std::span<const std::byte> data);
+
+    // Appends the last chunk and an empty trailer.
+    void write_last_chunk(std::pmr::string& out);
+} // namespace mio::http1
+
+#endif // INCLUDE_mio_http1_chunked_hpp
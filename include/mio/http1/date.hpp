@@ -0,0 +1,52 @@
+#ifndef INCLUDE_mio_http1_date_hpp
+#define INCLUDE_mio_http1_date_hpp
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+
+namespace mio::http1 {
+    // The length of an IMF-fixdate: "Sun, 06 Nov 1994 08:49:37 GMT".
+    inline constexpr std::size_t date_size = 29;
+
+    // Formats `time` as an IMF-fixdate.
+    std::array<char, date_size> format_date(std::time_t time) noexcept;
+
+    // The Date header line of the current second, "date: Sun, 06 Nov 1994 08:49:37 GMT\r\n".
+    // One thread refreshes it with update(), e.g. from a timer, while any number of threads copy it out with get()
+    // without locking. A reader that overlaps an update retries.
+    class date_header {
+    public:
+        static constexpr std::string_view prefix = "date: ";
+        static constexpr std::size_t size = prefix.size() + date_size + 2;
+
+        using line = std::array<char, size>;
+
+        explicit date_header(std::time_t now = std::time(nullptr)) noexcept;
+        ~date_header() noexcept = default;
+
+        // Uncopyable and unmovable
+        date_header(const date_header&) = delete;
+        date_header(date_header&&) = delete;
+
+        date_header& operator=(const date_header&) = delete;
+        date_header& operator=(date_header&&) = delete;
+
+        // Reformats the line if the second changed. Only one thread may update at a time.
+        void update(std::time_t now) noexcept;
+
+        [[nodiscard]] line get() const noexcept;
+
+    private:
+        static constexpr std::size_t word_count = (size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+        // A sequence lock: odd while the words are being written.
+        std::atomic<std::uint64_t> sequence_ = 0;
+        std::atomic<std::uint64_t> words_[word_count] = {};
+        std::time_t time_ = 0; // Only touched by the updating thread.
+    };
+} // namespace mio::http1
+
+#endif // INCLUDE_mio_http1_date_hpp
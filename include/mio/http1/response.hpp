@@ -1,10 +1,13 @@
 #ifndef INCLUDE_mio_http1_response_hpp
 #define INCLUDE_mio_http1_response_hpp
 
+#include <array>
 #include <cstdint>
+#include <memory_resource>
 #include <ostream>
 #include <span>
-#include <unordered_map>
+#include <string>
+#include <string_view>
 #include "header.hpp"
 
 namespace mio::http1 {
@@ -13,77 +16,108 @@ namespace mio::http1 {
         std::int32_t status_code;
         std::span<header> headers;
         std::span<const std::byte> body;
+        bool chunked = false; // Sends `transfer-encoding: chunked` instead of the body; the chunks follow separately.
     };
 
-    inline const std::unordered_map<std::int32_t, std::string_view> status_codes = {
-        {100, "Continue"},
-        {101, "Switching Protocols"},
-        {102, "Processing"},
-        {200, "OK"},
-        {201, "Created"},
-        {202, "Accepted"},
-        {203, "Non-Authoritative Information"},
-        {204, "No Content"},
-        {205, "Reset Content"},
-        {206, "Partial Content"},
-        {207, "Multi-Status"},
-        {208, "Already Reported"},
-        {300, "Multiple Choices"},
-        {301, "Moved Permanently"},
-        {302, "Found"},
-        {303, "See Other"},
-        {304, "Not Modified"},
-        {305, "Use Proxy"},
-        {307, "Temporary Redirect"},
-        {400, "Bad Request"},
-        {401, "Unauthorized"},
-        {402, "Payment Required"},
-        {403, "Forbidden"},
-        {404, "Not Found"},
-        {405, "Method Not Allowed"},
-        {406, "Not Acceptable"},
-        {407, "Proxy Authentication Required"},
-        {408, "Request Timeout"},
-        {409, "Conflict"},
-        {410, "Gone"},
-        {411, "Length Required"},
-        {412, "Precondition Failed"},
-        {413, "Request Entity Too Large"},
-        {414, "Request-URI Too Large"},
-        {415, "Unsupported Media Type"},
-        {416, "Request Range Not Satisfiable"},
-        {417, "Expectation Failed"},
-        {418, "I'm a teapot"},
-        {422, "Unprocessable Entity"},
-        {423, "Locked"},
-        {424, "Failed Dependency"},
-        {425, "No code"},
-        {426, "Upgrade Required"},
-        {428, "Precondition Required"},
-        {429, "Too Many Requests"},
-        {431, "Request Header Fields Too Large"},
-        {449, "Retry with"},
-        {500, "Internal Server Error"},
-        {501, "Not Implemented"},
-        {502, "Bad Gateway"},
-        {503, "Service Unavailable"},
-        {504, "Gateway Timeout"},
-        {505, "HTTP Version Not Supported"},
-        {506, "Variant Also Negotiates"},
-        {507, "Insufficient Storage"},
-        {509, "Bandwidth Limit Exceeded"},
-        {510, "Not Extended"},
-        {511, "Network Authentication Required"},
-    };
+    namespace detail {
+        // Every known status line, preformatted.
+        inline constexpr std::string_view status_lines[] = {
+            "HTTP/1.1 100 Continue\r\n",
+            "HTTP/1.1 101 Switching Protocols\r\n",
+            "HTTP/1.1 102 Processing\r\n",
+            "HTTP/1.1 200 OK\r\n",
+            "HTTP/1.1 201 Created\r\n",
+            "HTTP/1.1 202 Accepted\r\n",
+            "HTTP/1.1 203 Non-Authoritative Information\r\n",
+            "HTTP/1.1 204 No Content\r\n",
+            "HTTP/1.1 205 Reset Content\r\n",
+            "HTTP/1.1 206 Partial Content\r\n",
+            "HTTP/1.1 207 Multi-Status\r\n",
+            "HTTP/1.1 208 Already Reported\r\n",
+            "HTTP/1.1 300 Multiple Choices\r\n",
+            "HTTP/1.1 301 Moved Permanently\r\n",
+            "HTTP/1.1 302 Found\r\n",
+            "HTTP/1.1 303 See Other\r\n",
+            "HTTP/1.1 304 Not Modified\r\n",
+            "HTTP/1.1 305 Use Proxy\r\n",
+            "HTTP/1.1 307 Temporary Redirect\r\n",
+            "HTTP/1.1 400 Bad Request\r\n",
+            "HTTP/1.1 401 Unauthorized\r\n",
+            "HTTP/1.1 402 Payment Required\r\n",
+            "HTTP/1.1 403 Forbidden\r\n",
+            "HTTP/1.1 404 Not Found\r\n",
+            "HTTP/1.1 405 Method Not Allowed\r\n",
+            "HTTP/1.1 406 Not Acceptable\r\n",
+            "HTTP/1.1 407 Proxy Authentication Required\r\n",
+            "HTTP/1.1 408 Request Timeout\r\n",
+            "HTTP/1.1 409 Conflict\r\n",
+            "HTTP/1.1 410 Gone\r\n",
+            "HTTP/1.1 411 Length Required\r\n",
+            "HTTP/1.1 412 Precondition Failed\r\n",
+            "HTTP/1.1 413 Request Entity Too Large\r\n",
+            "HTTP/1.1 414 Request-URI Too Large\r\n",
+            "HTTP/1.1 415 Unsupported Media Type\r\n",
+            "HTTP/1.1 416 Request Range Not Satisfiable\r\n",
+            "HTTP/1.1 417 Expectation Failed\r\n",
+            "HTTP/1.1 418 I'm a teapot\r\n",
+            "HTTP/1.1 422 Unprocessable Entity\r\n",
+            "HTTP/1.1 423 Locked\r\n",
+            "HTTP/1.1 424 Failed Dependency\r\n",
+            "HTTP/1.1 425 No code\r\n",
+            "HTTP/1.1 426 Upgrade Required\r\n",
+            "HTTP/1.1 428 Precondition Required\r\n",
+            "HTTP/1.1 429 Too Many Requests\r\n",
+            "HTTP/1.1 431 Request Header Fields Too Large\r\n",
+            "HTTP/1.1 449 Retry with\r\n",
+            "HTTP/1.1 500 Internal Server Error\r\n",
+            "HTTP/1.1 501 Not Implemented\r\n",
+            "HTTP/1.1 502 Bad Gateway\r\n",
+            "HTTP/1.1 503 Service Unavailable\r\n",
+            "HTTP/1.1 504 Gateway Timeout\r\n",
+            "HTTP/1.1 505 HTTP Version Not Supported\r\n",
+            "HTTP/1.1 506 Variant Also Negotiates\r\n",
+            "HTTP/1.1 507 Insufficient Storage\r\n",
+            "HTTP/1.1 509 Bandwidth Limit Exceeded\r\n",
+            "HTTP/1.1 510 Not Extended\r\n",
+            "HTTP/1.1 511 Network Authentication Required\r\n",
+        };
+
+        // 1 + the index in status_lines of each status code from 100, or 0 for an unknown code.
+        inline constexpr auto status_line_indices = [] {
+            std::array<std::uint8_t, 500> indices{};
+            for (std::size_t i = 0; i < std::size(status_lines); i++) {
+                const auto line = status_lines[i];
+                const auto code = (line[9] - '0') * 100 + (line[10] - '0') * 10 + (line[11] - '0');
+                indices[code - 100] = static_cast<std::uint8_t>(i + 1);
+            }
+            return indices;
+        }();
+    } // namespace detail
 
-    inline std::string_view status_code_string(std::int32_t status_code) noexcept {
-        if (const auto it = status_codes.find(status_code); it != std::end(status_codes)) {
-            return it->second;
+    // "HTTP/1.1 200 OK\r\n" for 200. Empty for an unknown status code.
+    constexpr std::string_view status_line(std::int32_t status_code) noexcept {
+        if (status_code < 100 || status_code >= 600) {
+            return {};
+        }
+        if (const auto index = detail::status_line_indices[status_code - 100]; index > 0) {
+            return detail::status_lines[index - 1];
+        }
+        return {};
+    }
+
+    constexpr std::string_view status_code_string(std::int32_t status_code) noexcept {
+        if (const auto line = status_line(status_code); !line.empty()) {
+            constexpr std::size_t prefix_size = std::string_view{"HTTP/1.1 200 "}.size();
+            return line.substr(prefix_size, line.size() - prefix_size - 2);
         }
         return "Unknown";
     }
 
     void write_response(std::ostream& ostream, const response& res);
+    void write_response(std::pmr::string& out, const response& res);
+
+    // Everything up to the body, which the caller sends separately.
+    void write_response_head(std::pmr::string& out, const response& res);
 } // namespace mio::http1
 
 #endif // INCLUDE_mio_http1_response_hpp
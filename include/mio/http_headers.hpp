@@ -1,6 +1,7 @@
 #ifndef INCLUDE_mio_http_header_hpp
 #define INCLUDE_mio_http_header_hpp
 
+#include <memory_resource>
 #include <optional>
 #include <ranges>
 #include <span>
@@ -8,21 +9,23 @@
 #include <string_view>
 #include <unordered_map>
 #include <vector>
+#include "request_error.hpp"
+#include "util/string_hash.hpp"
 
 namespace mio {
     struct http_header {
-        std::string key;
-        std::string value;
+        std::pmr::string key;
+        std::pmr::string value;
     };
 
     class http_headers {
     public:
-        http_headers() = default;
+        explicit http_headers(std::pmr::memory_resource* resource = std::pmr::new_delete_resource());
 
-        explicit http_headers(std::initializer_list<http_header> headers);
+        explicit http_headers(std::initializer_list<http_header> headers, std::pmr::memory_resource* resource = std::pmr::new_delete_resource());
 
         template <std::ranges::range Headers>
-        explicit http_headers(const Headers& headers);
+        explicit http_headers(const Headers& headers, std::pmr::memory_resource* resource = std::pmr::new_delete_resource());
 
         ~http_headers() noexcept = default;
 
@@ -36,6 +39,9 @@ namespace mio {
         [[nodiscard]] std::optional<std::string_view> get(std::string_view key) const;
         void set(std::string_view key, std::string_view value);
         void append(std::string_view key, std::string_view value);
+
+        // Same as append(), but reports a repeated or malformed content-length instead of throwing.
+        request_result<void> try_append(std::string_view key, std::string_view value);
         void remove(std::string_view key);
 
         [[nodiscard]] std::span<http_header> entries() noexcept {
@@ -50,9 +56,13 @@ namespace mio {
             return content_length_;
         }
 
+        [[nodiscard]] std::pmr::memory_resource* resource() const noexcept {
+            return entries_.get_allocator().resource();
+        }
+
     private:
-        std::vector<http_header> entries_;
-        std::unordered_map<std::string, std::size_t> indices_;
+        std::pmr::vector<http_header> entries_;
+        std::pmr::unordered_map<std::pmr::string, std::size_t, util::string_hash, std::equal_to<>> indices_;
 
         std::size_t content_length_;
     };
@@ -1,20 +1,50 @@
 #ifndef INCLUDE_mio_http_request_hpp
 #define INCLUDE_mio_http_request_hpp
 
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include "bodies/x_www_form_url_encoded.hpp"
 #include "http_headers.hpp"
+#include "memory/arena.hpp"
+#include "sockets/endpoint.hpp"
+#include "url_encoded_fields.hpp"
 
 namespace mio {
+    struct route;
+
+    // Pulls a request body from the connection as the handler consumes it.
+    class body_reader {
+    public:
+        body_reader() = default;
+        virtual ~body_reader() noexcept = default;
+
+        // Reads up to buffer.size() bytes; returns 0 at the end of the body.
+        virtual std::size_t read_some(std::span<std::byte> buffer) = 0;
+
+    protected:
+        body_reader(const body_reader&) = default;
+        body_reader& operator=(const body_reader&) = default;
+    };
+
     class http_request {
     public:
-        http_request(std::string_view method, std::string_view request_uri, std::string_view http_version, http_headers&& headers, std::vector<std::byte>&& body = {})
-            : method_(method)
-            , request_uri_(request_uri)
+        http_request(std::string_view method, std::string_view request_uri, std::string_view http_version, http_headers&& headers, std::pmr::vector<std::byte>&& body = {}, std::pmr::memory_resource* resource = memory::current_resource())
+            : method_(method, resource)
+            , request_uri_(request_uri, resource)
             , query_index_(request_uri_.find('?'))
-            , http_version_(http_version)
+            , http_version_(http_version, resource)
+            , peer_()
             , headers_(std::move(headers))
-            , body_(std::move(body))
-            , params_()
-            , form_() {
+            , body_(std::move(body), resource)
+            , body_offset_(0)
+            , body_reader_(nullptr)
+            , body_file_(-1)
+            , body_file_size_(0)
+            , params_(resource)
+            , matched_route_(nullptr)
+            , query_(resource)
+            , form_(resource) {
         }
 
         ~http_request() noexcept = default;
@@ -26,7 +56,7 @@ namespace mio {
         http_request& operator=(const http_request&) = delete;
         http_request& operator=(http_request&&) = default;
 
-        [[nodiscard]] const std::string& method() const noexcept {
+        [[nodiscard]] std::string_view method() const noexcept {
             return method_;
         }
 
@@ -38,10 +68,36 @@ namespace mio {
             return request_uri().substr(0, query_index_);
         }
 
-        [[nodiscard]] const std::string& http_version() const noexcept {
+        [[nodiscard]] std::string_view query_string() const noexcept {
+            return query_index_ != std::string_view::npos ? request_uri().substr(query_index_ + 1) : std::string_view{};
+        }
+
+        // The query string is parsed on first access; values without escapes point into request_uri().
+        std::span<const url_encoded_field> query_params() const {
+            return parsed_query().entries();
+        }
+
+        std::optional<std::string_view> query(std::string_view key) const {
+            return parsed_query().get(key);
+        }
+
+        auto query_values(std::string_view key) const {
+            return parsed_query().get_all(key);
+        }
+
+        [[nodiscard]] std::string_view http_version() const noexcept {
             return http_version_;
         }
 
+        // The address of the client, as captured when the connection was accepted. Unspecified if unknown.
+        [[nodiscard]] const sockets::endpoint& peer() const noexcept {
+            return peer_;
+        }
+
+        void set_peer(const sockets::endpoint& peer) noexcept {
+            peer_ = peer;
+        }
+
         [[nodiscard]] http_headers& headers() noexcept {
             return headers_;
         }
@@ -50,56 +106,142 @@ namespace mio {
             return headers_;
         }
 
+        // The buffered body. Empty if the body is streamed; see read_some().
         [[nodiscard]] std::span<const std::byte> body() const noexcept {
             return body_;
         }
 
+        // Takes the buffer of `body` if it comes from the request's resource; copies it otherwise.
+        void set_body(std::pmr::vector<std::byte>&& body) {
+            body_ = std::move(body);
+            body_offset_ = 0;
+        }
+
+        // True if the body is left on the connection instead of being buffered (route_options::stream_body).
+        [[nodiscard]] bool is_body_streamed() const noexcept {
+            return body_reader_ != nullptr;
+        }
+
+        void set_body_reader(body_reader* reader) noexcept {
+            body_reader_ = reader;
+        }
+
+        // The file holding the body, positioned at its start, if the route stores it in one
+        // (route_options::body_file_directory); -1 otherwise. It is closed after the response, so a handler keeping
+        // the body links it with linkat(2) or dup(2)s the descriptor.
+        [[nodiscard]] int body_file() const noexcept {
+            return body_file_;
+        }
+
+        [[nodiscard]] std::size_t body_file_size() const noexcept {
+            return body_file_size_;
+        }
+
+        void set_body_file(int fd, std::size_t size) noexcept {
+            body_file_ = fd;
+            body_file_size_ = size;
+        }
+
+        // Reads the next bytes of the body, from the connection if streamed or from the buffered body otherwise.
+        // Returns 0 at the end of the body.
+        std::size_t read_some(std::span<std::byte> buffer) {
+            if (body_reader_ != nullptr) {
+                return body_reader_->read_some(buffer);
+            }
+
+            const auto n = std::min(buffer.size(), body_.size() - body_offset_);
+            std::copy_n(body_.data() + body_offset_, n, buffer.data());
+            body_offset_ += n;
+            return n;
+        }
+
+        // Calls sink with every remaining chunk of the body and returns the number of bytes read.
+        template <std::invocable<std::span<const std::byte>> Sink>
+        std::size_t read_body(Sink sink) {
+            std::size_t total = 0;
+
+            std::byte buffer[16 * 1024];
+            while (const auto n = read_some(buffer)) {
+                std::invoke(sink, std::span<const std::byte>{buffer, n});
+                total += n;
+            }
+
+            return total;
+        }
+
         [[nodiscard]] std::string_view body_as_text() const noexcept {
             return std::string_view{reinterpret_cast<const char*>(body_.data()), body_.size()};
         }
 
-        void set_param(std::string&& key, std::string&& value) {
-            params_.emplace(std::move(key), std::move(value));
+        void set_param(std::string_view key, std::string_view value) {
+            params_.emplace(key, value);
         }
 
-        std::optional<std::string_view> param(const std::string& key) const {
+        std::optional<std::string_view> param(std::string_view key) const {
             if (const auto it = params_.find(key); it != std::end(params_)) {
                 return it->second;
             }
             return std::nullopt;
         }
 
-        void set_form(std::string&& key, std::string&& value) {
-            if (const auto it = form_.find(key); it != std::end(form_)) {
-                it->second.emplace_back(std::move(value));
-            } else {
-                form_.emplace(std::move(key), std::vector<std::string>{std::move(value)});
-            }
+        // The route the router dispatched the request to; nullptr before routing, or if no route matched.
+        [[nodiscard]] const route* matched_route() const noexcept {
+            return matched_route_;
         }
 
-        std::optional<std::string_view> form(const std::string& key) const {
-            if (const auto p = form_values(key); p && !p->empty()) {
-                return p->front();
-            }
-            return std::nullopt;
+        void set_matched_route(const route* matched_route) noexcept {
+            matched_route_ = matched_route;
         }
 
-        const std::vector<std::string>* form_values(const std::string& key) const {
-            if (const auto it = form_.find(key); it != std::end(form_)) {
-                return &it->second;
-            }
-            return nullptr;
+        // An x-www-form-urlencoded body is parsed on first access; values without escapes point into body().
+        std::span<const url_encoded_field> form_params() const {
+            return parsed_form().entries();
+        }
+
+        std::optional<std::string_view> form(std::string_view key) const {
+            return parsed_form().get(key);
+        }
+
+        auto form_values(std::string_view key) const {
+            return parsed_form().get_all(key);
+        }
+
+        // Reports whether the query string or the form body had a malformed escape; such fields are left out of the accessors above.
+        [[nodiscard]] request_result<void> parse_query() const {
+            return query_.parse(query_string());
+        }
+
+        [[nodiscard]] request_result<void> parse_form() const {
+            return bodies::parse_x_www_form_url_encoded(bodies::is_x_www_form_url_encoded(headers_) ? body_as_text() : std::string_view{}, form_);
+        }
+
+    private:
+        const url_encoded_fields& parsed_query() const {
+            static_cast<void>(parse_query());
+            return query_;
+        }
+
+        const url_encoded_fields& parsed_form() const {
+            static_cast<void>(parse_form());
+            return form_;
         }
 
     private:
-        std::string method_;
-        std::string request_uri_;
+        std::pmr::string method_;
+        std::pmr::string request_uri_;
         std::size_t query_index_;
-        std::string http_version_;
+        std::pmr::string http_version_;
+        sockets::endpoint peer_;
         http_headers headers_;
-        std::vector<std::byte> body_;
-        std::unordered_map<std::string, std::string> params_;
-        std::unordered_map<std::string, std::vector<std::string>> form_;
+        std::pmr::vector<std::byte> body_;
+        std::size_t body_offset_;
+        body_reader* body_reader_;
+        int body_file_;
+        std::size_t body_file_size_;
+        std::pmr::unordered_map<std::pmr::string, std::pmr::string, util::string_hash, std::equal_to<>> params_;
+        const route* matched_route_;
+        mutable url_encoded_fields query_;
+        mutable url_encoded_fields form_;
     };
 } // namespace mio
 
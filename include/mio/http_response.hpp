@@ -2,31 +2,56 @@
 #define INCLUDE_mio_http_response_hpp
 
 #include <cassert>
+#include <functional>
+#include <memory>
 #include "http_headers.hpp"
 
 namespace mio {
+    class prebuilt_response;
+
+    // Sink of a streamed response body.
+    class body_writer {
+    public:
+        virtual ~body_writer() noexcept = default;
+
+        // Writes may be buffered up to a limit; past it they block until the client catches up.
+        virtual void write(std::span<const std::byte> bytes) = 0;
+
+        // Sends what is buffered now, e.g. for server-sent events.
+        virtual void flush() {
+        }
+
+        void write(std::string_view text) {
+            write(std::as_bytes(std::span{text}));
+        }
+    };
+
+    using body_writer_function = std::function<void(body_writer&)>;
+
     class http_response {
     public:
-        explicit http_response(std::int32_t status_code)
+        // Responses allocate from the heap unless given a resource, so they may be cached or kept past the request.
+        // A response built on a connection's arena must not outlive the request.
+        explicit http_response(std::int32_t status_code, std::pmr::memory_resource* resource = std::pmr::new_delete_resource())
             : status_code_(status_code)
-            , headers_()
-            , body_() {
+            , headers_(resource)
+            , body_(resource) {
         }
 
-        http_response(std::int32_t status_code, std::span<const std::byte> body)
+        http_response(std::int32_t status_code, std::span<const std::byte> body, std::pmr::memory_resource* resource = std::pmr::new_delete_resource())
             : status_code_(status_code)
-            , headers_()
-            , body_(std::begin(body), std::end(body)) {
+            , headers_(resource)
+            , body_(std::begin(body), std::end(body), resource) {
         }
 
-        http_response(std::int32_t status_code, std::string_view body)
-            : http_response(status_code, std::as_bytes(std::span{body})) {
+        http_response(std::int32_t status_code, std::string_view body, std::pmr::memory_resource* resource = std::pmr::new_delete_resource())
+            : http_response(status_code, std::as_bytes(std::span{body}), resource) {
         }
 
         http_response(std::int32_t status_code, http_headers&& headers, std::span<const std::byte> body)
             : status_code_(status_code)
             , headers_(std::move(headers))
-            , body_(std::begin(body), std::end(body)) {
+            , body_(std::begin(body), std::end(body), headers_.resource()) {
             assert(!headers_.get("content-length"));
         }
 
@@ -34,6 +59,14 @@ namespace mio {
             : http_response(status_code, std::move(headers), std::as_bytes(std::span{body})) {
         }
 
+        // Refers to bytes serialized ahead of time instead of carrying headers and a body; see mio::prebuilt().
+        http_response(std::int32_t status_code, std::shared_ptr<const prebuilt_response> prebuilt, std::pmr::memory_resource* resource = std::pmr::new_delete_resource())
+            : status_code_(status_code)
+            , headers_(resource)
+            , body_(resource)
+            , prebuilt_(std::move(prebuilt)) {
+        }
+
         ~http_response() noexcept = default;
 
         // Uncopyable and movable
@@ -88,6 +121,25 @@ namespace mio {
             write(std::as_bytes(std::span{text}));
         }
 
+        // Streams the body instead: `writer` is called after the headers are sent and the body goes out with the
+        // chunked transfer coding as it is written.
+        void stream(body_writer_function writer) {
+            body_.clear();
+            writer_ = std::move(writer);
+        }
+
+        [[nodiscard]] bool is_streamed() const noexcept {
+            return static_cast<bool>(writer_);
+        }
+
+        [[nodiscard]] const body_writer_function& stream_writer() const noexcept {
+            return writer_;
+        }
+
+        [[nodiscard]] const prebuilt_response* prebuilt() const noexcept {
+            return prebuilt_.get();
+        }
+
         static http_response html(std::int32_t status_code, std::string_view body) {
             return http_response{
                 status_code,
@@ -111,7 +163,9 @@ namespace mio {
     private:
         std::int32_t status_code_;
         http_headers headers_;
-        std::vector<std::byte> body_;
+        std::pmr::vector<std::byte> body_;
+        body_writer_function writer_;
+        std::shared_ptr<const prebuilt_response> prebuilt_;
     };
 } // namespace mio
 
@@ -1,31 +1,116 @@
 #ifndef INCLUDE_mio_http_server_hpp
 #define INCLUDE_mio_http_server_hpp
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+
+#include "http1/date.hpp"
 #include "http_request.hpp"
 #include "http_response.hpp"
+#include "metrics.hpp"
+#include "sockets/endpoint.hpp"
+#include "util/timer_wheel.hpp"
+#include "util/unique_fd.hpp"
 
 namespace mio {
     class application;
 
-    namespace sockets {
-        class socket;
-    } // namespace sockets
+    struct http_server_options {
+        // Larger request bodies are answered with 413 before they are read. route_options::max_body_size overrides it.
+        std::size_t max_body_size = 1024 * 1024;
+
+        // Connections are closed when a timeout passes, with a 408 if a request was partly received.
+        // Zero disables a timeout.
+        std::chrono::milliseconds idle_timeout = std::chrono::seconds{60};   // Until the next request on a kept-alive connection.
+        std::chrono::milliseconds header_timeout = std::chrono::seconds{10}; // For all of the request headers.
+        std::chrono::milliseconds body_timeout = std::chrono::seconds{30};   // Between two reads of the request body.
+        std::chrono::milliseconds write_timeout = std::chrono::seconds{30};  // For each send of the response.
+
+        // Output queued on a connection past which streamed bodies block, and pipelined responses are sent.
+        std::size_t output_high_water_mark = 64 * 1024;
+
+        // Answers GET requests for this path, e.g. "/metrics", with the metrics of the server in the Prometheus text
+        // format, before they reach the application. Unset, nothing is recorded.
+        std::optional<std::string> metrics_path{};
+    };
+
+    // Settings of a listening socket and of the connections accepted from it. Zero keeps the system default.
+    struct listen_options {
+        int backlog = SOMAXCONN; // Capped by net.core.somaxconn. Only the backlog applies to Unix domain sockets.
+        bool reuse_addr = true;
+        bool keep_alive = false;     // SO_KEEPALIVE probes on idle connections.
+        int send_buffer_size = 0;    // SO_SNDBUF, inherited by accepted sockets.
+        int receive_buffer_size = 0; // SO_RCVBUF, inherited by accepted sockets.
+        int defer_accept = 0;        // TCP_DEFER_ACCEPT: seconds to wait for the first bytes before accepting.
+        int fast_open = 0;           // TCP_FASTOPEN queue length.
+        bool no_delay = true;        // TCP_NODELAY on accepted sockets.
+        bool cork = true;            // TCP_CORK while a streamed response goes out, so the headers share a segment with the body.
+
+        // Response bodies at least this large are sent with MSG_ZEROCOPY instead of being copied into the socket buffer.
+        // The connection then waits for the kernel to release the body before its next request. This pays off for
+        // bodies of a few hundred KiB and more sent through a NIC; on loopback the kernel copies anyway, and it is
+        // turned off for the connection as soon as that is reported. Zero disables it.
+        std::size_t zero_copy_threshold = 0;
+    };
+
+    struct listener {
+        sockets::endpoint endpoint;
+        listen_options options{};
+    };
 
     class http_server {
     public:
-        http_server(std::unique_ptr<application>&& app);
+        explicit http_server(std::unique_ptr<application>&& app, const http_server_options& options = {});
         ~http_server() noexcept;
 
-        void listen(std::uint16_t port);
+        // These never return. Listening on port alone binds every IPv6 and IPv4 address, or every IPv4 one on hosts
+        // without IPv6.
+        void listen(std::uint16_t port, const listen_options& options = {});
+        void listen(const sockets::endpoint& endpoint, const listen_options& options = {});
+        void listen(std::span<const listener> listeners);
+
+        // Runs the request pipeline of one connected stream on the calling thread until the connection is closed,
+        // as if it had been accepted from a listener with `options`. Together with sockets::socket::pair() this
+        // drives the full parse, route, handle and serialize path without a network. Thread-safe.
+        void serve(sockets::socket client_socket, const sockets::endpoint& peer = {}, const listen_options& options = {}) noexcept;
+
+        // nullptr unless http_server_options::metrics_path is set.
+        [[nodiscard]] const metrics* get_metrics() const noexcept {
+            return metrics_.get();
+        }
 
     private:
-        static void on_client_accepted(http_server* self, sockets::socket client_socket) noexcept;
+        void start_timers();
+        http_response metrics_response() const;
+        void accept_batch(const listener& l, sockets::socket& socket, util::unique_fd& reserve_fd);
+        static void serve_connection(http_server* self, const listen_options* options, sockets::socket client_socket, sockets::endpoint peer) noexcept;
 
     private:
         std::unique_ptr<application> app_;
+        http_server_options options_;
+
+        // A timer for every connection, advanced by the timer thread. Connections take the mutex only when they open
+        // and close, not to arm their deadlines.
+        util::timer_wheel timers_;
+        std::mutex timers_mutex_;
+        std::once_flag timers_started_;
+
+        // The Date header of every response, refreshed by the timer thread.
+        http1::date_header date_;
+
+        std::unique_ptr<metrics> metrics_;
+
+        // Declared last, so that it is joined before what it touches is destroyed.
+        std::jthread timer_thread_;
 
     private:
         // Uncopyable and unmovable
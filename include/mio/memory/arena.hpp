@@ -0,0 +1,63 @@
+#ifndef INCLUDE_mio_memory_arena_hpp
+#define INCLUDE_mio_memory_arena_hpp
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace mio::memory {
+    // Returns the resource that requests created on this thread allocate from by default. Responses and headers
+    // default to the heap instead, since a handler may keep them past the request.
+    // This is std::pmr::get_default_resource() unless a resource_scope is active.
+    [[nodiscard]] std::pmr::memory_resource* current_resource() noexcept;
+
+    // Makes `resource` the current resource of this thread during its lifetime.
+    class resource_scope {
+    public:
+        explicit resource_scope(std::pmr::memory_resource* resource) noexcept;
+        ~resource_scope() noexcept;
+
+    private:
+        std::pmr::memory_resource* previous_;
+
+    private:
+        // Uncopyable and unmovable
+        resource_scope(const resource_scope&) = delete;
+        resource_scope(resource_scope&&) = delete;
+
+        resource_scope& operator=(const resource_scope&) = delete;
+        resource_scope& operator=(resource_scope&&) = delete;
+    };
+
+    // A monotonic arena over a pooled block, owned by a connection and reset between requests.
+    // Allocations beyond the block fall back to the upstream resource until the next reset().
+    class arena {
+    public:
+        static constexpr std::size_t block_size = 64 * 1024;
+
+        arena();
+        ~arena() noexcept;
+
+        [[nodiscard]] std::pmr::memory_resource* resource() noexcept {
+            return &resource_;
+        }
+
+        // Releases everything allocated since the last reset. Objects allocated from the arena must be dead.
+        void reset() noexcept {
+            resource_.release();
+        }
+
+    private:
+        std::byte* block_;
+        std::pmr::monotonic_buffer_resource resource_;
+
+    private:
+        // Uncopyable and unmovable
+        arena(const arena&) = delete;
+        arena(arena&&) = delete;
+
+        arena& operator=(const arena&) = delete;
+        arena& operator=(arena&&) = delete;
+    };
+} // namespace mio::memory
+
+#endif // INCLUDE_mio_memory_arena_hpp
@@ -0,0 +1,102 @@
+#ifndef INCLUDE_mio_metrics_hpp
+#define INCLUDE_mio_metrics_hpp
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "request_error.hpp"
+
+namespace mio {
+    struct route;
+
+    // What a server has answered: requests by route template, method and status, latencies by route, bytes in and
+    // out, active connections and refused requests. Written out in the Prometheus text format on scrape.
+    //
+    // Recording is lock-free and a scrape merges the shards recorded into. A recorder, kept by each connection,
+    // claims a shard of its own and updates it with plain relaxed stores, which cost a few nanoseconds. Once every
+    // such shard is claimed, recorders share the other shards with the record_*() functions below, through atomic
+    // additions. A (route, method) series is allocated the first time a shard sees it.
+    class metrics {
+    private:
+        struct series;
+        struct shard;
+
+    public:
+        // The methods with series of their own; every other method is counted as "OTHER".
+        static constexpr std::string_view methods[] = {"GET", "HEAD", "POST", "PUT", "DELETE", "PATCH", "OPTIONS", "OTHER"};
+
+        // Upper bounds of the latency histogram buckets in microseconds, from 50us to 10s. Longer latencies are only
+        // counted in the +Inf bucket.
+        static constexpr std::uint64_t latency_buckets_us[] = {
+            50, 100, 250, 500, 1'000, 2'500, 5'000, 10'000, 25'000, 50'000, 100'000, 250'000, 500'000,
+            1'000'000, 2'500'000, 5'000'000, 10'000'000,
+        };
+
+        // Statuses a (route, method) series counts apart; further ones are counted as dropped.
+        static constexpr std::size_t max_statuses = 8;
+
+        // Records from one thread at a time.
+        class recorder {
+        public:
+            explicit recorder(metrics& m) noexcept;
+            ~recorder() noexcept;
+
+            // Uncopyable and unmovable
+            recorder(const recorder&) = delete;
+            recorder(recorder&&) = delete;
+
+            recorder& operator=(const recorder&) = delete;
+            recorder& operator=(recorder&&) = delete;
+
+            [[nodiscard]] bool is_exclusive() const noexcept {
+                return exclusive_;
+            }
+
+            void record_request(const route* route, std::size_t method, std::int32_t status, std::chrono::nanoseconds latency) noexcept;
+            void record_request_error(request_error error) noexcept;
+            void record_bytes(std::uint64_t received, std::uint64_t sent) noexcept;
+
+        private:
+            shard* shard_;
+            bool exclusive_;
+        };
+
+        // Zero picks one shared shard per hardware thread, and twice as many to be claimed.
+        explicit metrics(std::size_t shard_count = 0);
+        ~metrics() noexcept;
+
+        // Uncopyable and unmovable
+        metrics(const metrics&) = delete;
+        metrics(metrics&&) = delete;
+
+        metrics& operator=(const metrics&) = delete;
+        metrics& operator=(metrics&&) = delete;
+
+        // The index of `method` in `methods`.
+        [[nodiscard]] static std::size_t method_index(std::string_view method) noexcept;
+
+        // `route` is the route that answered, or nullptr if none did (no route matched, or a middleware answered).
+        void record_request(const route* route, std::size_t method, std::int32_t status, std::chrono::nanoseconds latency) noexcept;
+        void record_request_error(request_error error) noexcept;
+        void record_bytes(std::uint64_t received, std::uint64_t sent) noexcept;
+
+        void connection_opened() noexcept;
+        void connection_closed() noexcept;
+
+        // Appends every metric in the Prometheus text exposition format, version 0.0.4.
+        void write_prometheus(std::string& output) const;
+
+    private:
+        shard& shared_shard() noexcept;
+
+    private:
+        std::vector<std::unique_ptr<shard>> shared_shards_;
+        std::vector<std::unique_ptr<shard>> exclusive_shards_;
+    };
+} // namespace mio
+
+#endif // INCLUDE_mio_metrics_hpp
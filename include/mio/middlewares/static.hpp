@@ -2,6 +2,7 @@
 #define INCLUDE_mio_middlewares_static_hpp
 
 #include <filesystem>
+#include <optional>
 #include <string_view>
 
 namespace mio {
@@ -23,8 +24,20 @@ namespace mio::middlewares {
 
         ~static_() noexcept = default;
 
+        // Post-processing middleware: replaces a 404 response under base_uri with the file.
         void operator()(http_request& req, http_response& res) const;
 
+        // Mount handler: serves `path` relative to the directory, e.g. router.mount("/assets", static_{"./assets"}).
+        std::optional<http_response> operator()(http_request& req, std::string_view path) const;
+
+    private:
+        struct file {
+            std::filesystem::path path;
+            std::string content;
+        };
+
+        std::optional<file> find_file(const http_request& req, std::string_view path) const;
+
     private:
         std::filesystem::path path_;
         std::string base_uri_;
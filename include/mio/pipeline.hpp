@@ -0,0 +1,112 @@
+#ifndef INCLUDE_mio_pipeline_hpp
+#define INCLUDE_mio_pipeline_hpp
+
+#include <concepts>
+#include <functional>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include "http_request.hpp"
+#include "http_response.hpp"
+#include "util/path.hpp"
+
+namespace mio {
+    // A middleware chain composed at compile time.
+    // Each layer is called as `layer(req, next)` and returns the response; `next(req)` runs the rest of the chain.
+    // Since every `next` has a distinct concrete type, the whole chain can be inlined into the handler.
+    //
+    //   router.get("/api/items", mio::make_pipeline(handler, mio::layers::before(auth), mio::layers::after(cors)));
+    template <typename Handler, typename... Layers>
+    class pipeline {
+    public:
+        explicit pipeline(Handler handler, Layers... layers)
+            : handler_(std::move(handler))
+            , layers_(std::move(layers)...) {
+        }
+
+        http_response operator()(http_request& req) {
+            return call<0>(req);
+        }
+
+    private:
+        template <std::size_t I>
+        http_response call(http_request& req) {
+            if constexpr (I == sizeof...(Layers)) {
+                return std::invoke(handler_, req);
+            } else {
+                return std::invoke(std::get<I>(layers_), req, [this](http_request& r) { return call<I + 1>(r); });
+            }
+        }
+
+    private:
+        Handler handler_;
+        std::tuple<Layers...> layers_;
+    };
+
+    template <typename Handler, typename... Layers>
+    pipeline<std::decay_t<Handler>, std::decay_t<Layers>...> make_pipeline(Handler&& handler, Layers&&... layers) {
+        return pipeline<std::decay_t<Handler>, std::decay_t<Layers>...>{std::forward<Handler>(handler), std::forward<Layers>(layers)...};
+    }
+
+    namespace layers {
+        // Adapts `std::optional<http_response>(http_request&)`; a response short-circuits the chain.
+        template <typename F>
+        struct before_layer {
+            F f;
+
+            template <typename Next>
+            http_response operator()(http_request& req, Next&& next) {
+                if (std::optional<http_response> res = std::invoke(f, req)) {
+                    return std::move(*res);
+                }
+                return next(req);
+            }
+        };
+
+        // Adapts `void(http_request&, http_response&)`.
+        template <typename F>
+        struct after_layer {
+            F f;
+
+            template <typename Next>
+            http_response operator()(http_request& req, Next&& next) {
+                http_response res = next(req);
+                std::invoke(f, req, res);
+                return res;
+            }
+        };
+
+        // Runs `layer` only for the paths under `prefix`.
+        template <typename Layer>
+        struct scoped_layer {
+            std::string prefix;
+            Layer layer;
+
+            template <typename Next>
+            http_response operator()(http_request& req, Next&& next) {
+                if (util::has_path_prefix(req.path(), prefix)) {
+                    return std::invoke(layer, req, std::forward<Next>(next));
+                }
+                return next(req);
+            }
+        };
+
+        template <typename F>
+        before_layer<std::decay_t<F>> before(F&& f) {
+            return {std::forward<F>(f)};
+        }
+
+        template <typename F>
+        after_layer<std::decay_t<F>> after(F&& f) {
+            return {std::forward<F>(f)};
+        }
+
+        template <typename Layer>
+        scoped_layer<std::decay_t<Layer>> scoped(std::string_view prefix, Layer&& layer) {
+            return {util::normalize_prefix(prefix), std::forward<Layer>(layer)};
+        }
+    } // namespace layers
+} // namespace mio
+
+#endif // INCLUDE_mio_pipeline_hpp
@@ -0,0 +1,57 @@
+#ifndef INCLUDE_mio_prebuilt_response_hpp
+#define INCLUDE_mio_prebuilt_response_hpp
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include "router.hpp"
+
+namespace mio {
+    // A constant response serialized to wire bytes once, for endpoints such as health checks and robots.txt.
+    // Serving it queues the shared bytes as they are: the head, then the current Date and Connection headers, then the
+    // body, which is stored once for both kinds of connection.
+    class prebuilt_response {
+    public:
+        explicit prebuilt_response(const http_response& res);
+        ~prebuilt_response() noexcept = default;
+
+        // Uncopyable and unmovable
+        prebuilt_response(const prebuilt_response&) = delete;
+        prebuilt_response(prebuilt_response&&) = delete;
+
+        prebuilt_response& operator=(const prebuilt_response&) = delete;
+        prebuilt_response& operator=(prebuilt_response&&) = delete;
+
+        [[nodiscard]] std::int32_t status_code() const noexcept {
+            return status_code_;
+        }
+
+        // The status line and the headers, Content-Length included. More headers may be sent after it.
+        [[nodiscard]] std::span<const std::byte> head() const noexcept {
+            return std::as_bytes(std::span{head_});
+        }
+
+        // The Connection header and the empty line ending the head.
+        [[nodiscard]] static std::string_view connection_line(bool keep_alive) noexcept {
+            return keep_alive ? "connection: keep-alive\r\n\r\n" : "connection: close\r\n\r\n";
+        }
+
+        [[nodiscard]] std::span<const std::byte> body() const noexcept {
+            return std::as_bytes(std::span{body_});
+        }
+
+    private:
+        std::int32_t status_code_;
+        std::string head_;
+        std::string body_;
+    };
+
+    // Serializes `res` once and returns a handler serving it to every request. The response must not be streamed.
+    // Its headers and body are final: middlewares changing them after the handler have no effect.
+    //
+    //   router.get("/healthz", mio::prebuilt(mio::http_response::json(200, R"({"status":"ok"})")));
+    request_handler prebuilt(const http_response& res);
+} // namespace mio
+
+#endif // INCLUDE_mio_prebuilt_response_hpp
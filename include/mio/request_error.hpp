@@ -0,0 +1,43 @@
+#ifndef INCLUDE_mio_request_error_hpp
+#define INCLUDE_mio_request_error_hpp
+
+#include <cstdint>
+#include <stdexcept>
+#include "util/expected.hpp"
+
+namespace mio {
+    // Why a malformed request is refused, as the status code of the response.
+    // These are returned rather than thrown: junk traffic must not cost an exception per request.
+    enum class request_error : std::int32_t {
+        bad_request = 400,
+        payload_too_large = 413,
+        header_fields_too_large = 431,
+        http_version_not_supported = 505,
+    };
+
+    [[nodiscard]] constexpr std::int32_t status_code(request_error error) noexcept {
+        return static_cast<std::int32_t>(error);
+    }
+
+    template <typename T>
+    using request_result = util::expected<T, request_error>;
+
+    // A request_error found while the body is read, possibly from within a handler, where it cannot be returned.
+    // The server answers it with application::on_request_error() and closes the connection.
+    class request_error_exception : public std::runtime_error {
+    public:
+        explicit request_error_exception(request_error error)
+            : std::runtime_error{error == request_error::payload_too_large ? "payload too large" : "bad request"}
+            , error_(error) {
+        }
+
+        [[nodiscard]] request_error error() const noexcept {
+            return error_;
+        }
+
+    private:
+        request_error error_;
+    };
+} // namespace mio
+
+#endif // INCLUDE_mio_request_error_hpp
@@ -0,0 +1,80 @@
+#ifndef INCLUDE_mio_request_stage_hpp
+#define INCLUDE_mio_request_stage_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mio {
+    // Where the current thread is in handling a request. The server and the router mark each stage as they enter it,
+    // so that tools such as an allocation counter can attribute costs to stages. Marking is one thread-local store.
+    enum class request_stage : std::uint8_t {
+        idle,      // Not handling a request, e.g. setting up or tearing down a connection.
+        parse,     // Receiving and parsing the request line and headers.
+        headers,   // Building the request and its header map.
+        routing,   // Finding the route, its options and parameters.
+        body,      // Receiving the request body.
+        handler,   // Middlewares and the request handler.
+        serialize, // Formatting and sending the response.
+    };
+
+    inline constexpr std::size_t request_stage_count = 7;
+
+    namespace detail {
+        inline thread_local request_stage current_request_stage = request_stage::idle;
+    } // namespace detail
+
+    [[nodiscard]] inline request_stage current_request_stage() noexcept {
+        return detail::current_request_stage;
+    }
+
+    inline void enter_request_stage(request_stage stage) noexcept {
+        detail::current_request_stage = stage;
+    }
+
+    // Marks the thread idle when it leaves the scope, however it leaves.
+    class request_stage_scope {
+    public:
+        request_stage_scope() noexcept = default;
+
+        ~request_stage_scope() noexcept {
+            enter_request_stage(request_stage::idle);
+        }
+
+        // Uncopyable and unmovable
+        request_stage_scope(const request_stage_scope&) = delete;
+        request_stage_scope(request_stage_scope&&) = delete;
+
+        request_stage_scope& operator=(const request_stage_scope&) = delete;
+        request_stage_scope& operator=(request_stage_scope&&) = delete;
+    };
+
+    // Enters `stage` and goes back to the previous stage when it leaves the scope, however it leaves. Outside of a
+    // request, while the thread is idle, it does nothing.
+    class request_stage_switch {
+    public:
+        explicit request_stage_switch(request_stage stage) noexcept
+            : previous_(current_request_stage()) {
+            if (previous_ != request_stage::idle) {
+                enter_request_stage(stage);
+            }
+        }
+
+        ~request_stage_switch() noexcept {
+            if (previous_ != request_stage::idle) {
+                enter_request_stage(previous_);
+            }
+        }
+
+        // Uncopyable and unmovable
+        request_stage_switch(const request_stage_switch&) = delete;
+        request_stage_switch(request_stage_switch&&) = delete;
+
+        request_stage_switch& operator=(const request_stage_switch&) = delete;
+        request_stage_switch& operator=(request_stage_switch&&) = delete;
+
+    private:
+        request_stage previous_;
+    };
+} // namespace mio
+
+#endif // INCLUDE_mio_request_stage_hpp
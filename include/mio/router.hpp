@@ -4,9 +4,13 @@
 #include <concepts>
 #include <functional>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "request_error.hpp"
+#include "util/string_hash.hpp"
 
 namespace mio {
     class http_request;
@@ -15,20 +19,57 @@ namespace mio {
 
     using request_handler = std::function<http_response(http_request&)>;
 
+    // Handles the requests under a mounted prefix that no route matches.
+    // The second argument is the remaining path ("" or "/..."); returning std::nullopt falls through to the next mount.
+    using mount_handler = std::function<std::optional<http_response>(http_request&, std::string_view)>;
+
+    // Per-route settings that apply before the handler runs, while the request body is still unread.
+    struct route_options {
+        // Leave the body on the connection for the handler to pull with http_request::read_some().
+        bool stream_body = false;
+
+        // Overrides http_server_options::max_body_size.
+        std::optional<std::size_t> max_body_size{};
+
+        // Store the body in an unnamed temporary file in this directory instead of memory, for the handler to take
+        // from http_request::body_file(). A Content-Length body is spliced from the socket without entering user space.
+        std::optional<std::string> body_file_directory{};
+
+        bool operator==(const route_options&) const = default;
+    };
+
+    struct route {
+        request_handler handler;
+        route_options options;
+
+        // The path as registered, e.g. "/users/:id".
+        std::string pattern;
+    };
+
+    // Placeholder names with their decoded values, which point into the path or into the decode buffer.
+    using route_params = std::pmr::vector<std::pair<std::string_view, std::string_view>>;
+
     class routing_tree {
     public:
         routing_tree(std::string_view name, std::optional<std::string>&& placeholder);
         ~routing_tree() noexcept = default;
 
-        void insert(std::string_view path, const std::string& method, request_handler&& handler);
+        void insert(std::string_view path, const std::string& method, request_handler&& handler, const route_options& options = {});
 
-        const request_handler* find(std::string_view path, const std::string& method, std::vector<std::pair<std::string_view, std::string>>& params) const;
+        // `buffer` needs room for path.size() chars. A segment with escapes is decoded into it at the segment's offset
+        // in the path, so that the lookup does not allocate.
+        const request_handler* find(std::string_view path, std::string_view method, route_params& params, char* buffer) const;
+        // Fails with request_error::bad_request when a segment matched against a placeholder has a malformed escape.
+        request_result<const route*> find_route(std::string_view path, std::string_view method, route_params& params, char* buffer) const;
+
+    private:
+        void insert(std::string_view path, const std::string& method, route&& r);
 
     private:
         std::string name_;
         std::unordered_map<std::string_view, std::unique_ptr<routing_tree>> children_;
         std::vector<std::unique_ptr<routing_tree>> wildcards_;
-        std::unordered_map<std::string, request_handler> actions_;
+        std::unordered_map<std::string, route, util::string_hash, std::equal_to<>> actions_;
         std::optional<std::string> placeholder_;
 
     private:
@@ -55,24 +96,26 @@ namespace mio {
         ~scope_inserter() noexcept = default;
 
     public:
-        void add(std::string_view path, std::string_view method, request_handler&& handler);
+        void add(std::string_view path, std::string_view method, request_handler&& handler, const route_options& options = {});
 
-        void get(std::string_view path, request_handler&& handler) {
-            add(path, "GET", std::move(handler));
+        void get(std::string_view path, request_handler&& handler, const route_options& options = {}) {
+            add(path, "GET", std::move(handler), options);
         }
 
-        void post(std::string_view path, request_handler&& handler) {
-            add(path, "POST", std::move(handler));
+        void post(std::string_view path, request_handler&& handler, const route_options& options = {}) {
+            add(path, "POST", std::move(handler), options);
         }
 
-        void put(std::string_view path, request_handler&& handler) {
-            add(path, "PUT", std::move(handler));
+        void put(std::string_view path, request_handler&& handler, const route_options& options = {}) {
+            add(path, "PUT", std::move(handler), options);
         }
 
-        void delete_(std::string_view path, request_handler&& handler) {
-            add(path, "DELETE", std::move(handler));
+        void delete_(std::string_view path, request_handler&& handler, const route_options& options = {}) {
+            add(path, "DELETE", std::move(handler), options);
         }
 
+        void mount(std::string_view path, mount_handler&& handler);
+
         template <std::invocable<scope_inserter&> F>
         void scope(std::string_view path, F f) {
             std::string prefix = prefix_;
@@ -103,36 +146,50 @@ namespace mio {
 
         ~router() noexcept = default;
 
-        void add(std::string_view path, std::string_view method, request_handler&& handler) {
-            tree_.insert(path, std::string{method}, std::move(handler));
+        void add(std::string_view path, std::string_view method, request_handler&& handler, const route_options& options = {}) {
+            has_route_options_ |= options != route_options{};
+            tree_.insert(path, std::string{method}, std::move(handler), options);
         }
 
-        void get(std::string_view path, request_handler&& handler) {
-            add(path, "GET", std::move(handler));
+        void get(std::string_view path, request_handler&& handler, const route_options& options = {}) {
+            add(path, "GET", std::move(handler), options);
         }
 
-        void post(std::string_view path, request_handler&& handler) {
-            add(path, "POST", std::move(handler));
+        void post(std::string_view path, request_handler&& handler, const route_options& options = {}) {
+            add(path, "POST", std::move(handler), options);
         }
 
-        void put(std::string_view path, request_handler&& handler) {
-            add(path, "PUT", std::move(handler));
+        void put(std::string_view path, request_handler&& handler, const route_options& options = {}) {
+            add(path, "PUT", std::move(handler), options);
         }
 
-        void delete_(std::string_view path, request_handler&& handler) {
-            add(path, "DELETE", std::move(handler));
+        void delete_(std::string_view path, request_handler&& handler, const route_options& options = {}) {
+            add(path, "DELETE", std::move(handler), options);
         }
 
+        void mount(std::string_view path, mount_handler&& handler);
+
         template <std::invocable<scope_inserter&> F>
         void scope(std::string_view path, F f) {
             scope_inserter scope{*this, path};
             std::invoke(f, scope);
         }
 
-        std::optional<http_response> handle_request(http_request& req) const;
+        // Returns std::nullopt if no route matches, or an error if the path cannot be matched at all.
+        request_result<std::optional<http_response>> handle_request(http_request& req) const;
+
+        // Returns the options of the route matching req, or the defaults.
+        request_result<route_options> find_options(const http_request& req) const;
 
     private:
+        struct mount_point {
+            std::string prefix;
+            mount_handler handler;
+        };
+
         routing_tree tree_;
+        std::vector<mount_point> mounts_;
+        bool has_route_options_ = false;
 
     private:
         // Uncopyable and unmovable
@@ -143,11 +200,18 @@ namespace mio {
         router& operator=(router&&) = delete;
     };
 
-    inline void scope_inserter::add(std::string_view path, std::string_view method, request_handler&& handler) {
+    inline void scope_inserter::add(std::string_view path, std::string_view method, request_handler&& handler, const route_options& options) {
+        std::string full_path = prefix_;
+        full_path += path.starts_with('/') ? path.substr(1) : path;
+
+        router_.add(full_path, method, std::move(handler), options);
+    }
+
+    inline void scope_inserter::mount(std::string_view path, mount_handler&& handler) {
         std::string full_path = prefix_;
         full_path += path.starts_with('/') ? path.substr(1) : path;
 
-        router_.add(full_path, method, std::move(handler));
+        router_.mount(full_path, std::move(handler));
     }
 } // namespace mio
 
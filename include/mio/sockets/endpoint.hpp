@@ -0,0 +1,61 @@
+#ifndef INCLUDE_mio_sockets_endpoint_hpp
+#define INCLUDE_mio_sockets_endpoint_hpp
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <sys/socket.h>
+
+#include "socket.hpp"
+
+namespace mio::sockets {
+    // A socket address: IPv4, IPv6 or a Unix domain socket path.
+    class endpoint {
+    public:
+        endpoint() noexcept = default;
+        endpoint(const ::sockaddr* addr, ::socklen_t size) noexcept;
+
+        // Every local address on `port`. IPv4 clients are accepted too, since IPv6 listeners are dual-stack.
+        static endpoint any(std::uint16_t port) noexcept;
+
+        // Every local IPv4 address on `port`, for hosts without IPv6.
+        static endpoint any_v4(std::uint16_t port) noexcept;
+
+        // A numeric IPv4 or IPv6 address such as "127.0.0.1" or "::1".
+        static endpoint inet(std::string_view address, std::uint16_t port);
+
+        // A Unix domain socket path. A leading '@' names a socket in the abstract namespace.
+        static endpoint local(std::string_view path);
+
+        [[nodiscard]] address_family family() const noexcept {
+            return static_cast<address_family>(storage_.ss_family);
+        }
+
+        [[nodiscard]] const ::sockaddr* data() const noexcept {
+            return reinterpret_cast<const ::sockaddr*>(&storage_);
+        }
+
+        [[nodiscard]] ::socklen_t size() const noexcept {
+            return size_;
+        }
+
+        // 0 for Unix domain sockets.
+        [[nodiscard]] std::uint16_t port() const noexcept;
+
+        // Whether the address is the IPv4 or IPv6 wildcard, as made by any() and any_v4().
+        [[nodiscard]] bool is_any() const noexcept;
+
+        // The path of a Unix domain socket, "@..." for an abstract one.
+        [[nodiscard]] std::string path() const;
+
+        // "127.0.0.1:80", "[::1]:80" or "unix:/run/mio.sock".
+        [[nodiscard]] std::string to_string() const;
+
+    private:
+        ::sockaddr_storage storage_{};
+        ::socklen_t size_ = 0;
+    };
+} // namespace mio::sockets
+
+#endif // INCLUDE_mio_sockets_endpoint_hpp
@@ -0,0 +1,108 @@
+#ifndef INCLUDE_mio_sockets_output_buffer_hpp
+#define INCLUDE_mio_sockets_output_buffer_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "socket.hpp"
+
+namespace mio::sockets {
+    // Pending output of a connection. Small writes are copied and coalesced, large ones can be queued by
+    // reference, and everything goes out in gathered sends that resume after partial writes.
+    class output_buffer {
+    public:
+        // Referenced writes up to this size are copied anyway; a separate iovec is not worth it.
+        static constexpr std::size_t copy_threshold = 1024;
+
+        explicit output_buffer(socket& socket) noexcept
+            : socket_(socket) {
+        }
+
+        ~output_buffer() noexcept = default;
+
+        // Uncopyable and unmovable
+        output_buffer(const output_buffer&) = delete;
+        output_buffer(output_buffer&&) = delete;
+
+        output_buffer& operator=(const output_buffer&) = delete;
+        output_buffer& operator=(output_buffer&&) = delete;
+
+        void write(std::span<const std::byte> bytes);
+
+        void write(std::string_view text) {
+            write(std::as_bytes(std::span{text}));
+        }
+
+        // Queues `bytes` without copying them; they must stay valid until flushed.
+        void write_ref(std::span<const std::byte> bytes);
+
+        // Queues `bytes` like write_ref(), to be sent with MSG_ZEROCOPY if zero copy is enabled and they are at least
+        // the threshold long. They must then stay unmodified until zero_copy_pending() is false, not just until flushed.
+        void write_zero_copy(std::span<const std::byte> bytes);
+
+        // Sends zero-copy writes of at least `threshold` bytes straight from their pages. Returns false if the socket
+        // does not support it. It turns itself off once the kernel reports copying the data anyway, which costs more
+        // than a plain send.
+        bool enable_zero_copy(std::size_t threshold);
+
+        // Collects the completions of zero-copy sends without waiting. Returns true if none is pending anymore.
+        bool reap_zero_copy();
+
+        // Sends what the socket takes without blocking. Returns true once everything is sent.
+        bool try_flush();
+
+        // Sends everything, waiting for the socket to become writable.
+        void flush();
+
+        [[nodiscard]] std::size_t size() const noexcept {
+            return size_;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size_ == 0;
+        }
+
+        // Everything sent so far.
+        [[nodiscard]] std::uint64_t bytes_sent() const noexcept {
+            return bytes_sent_;
+        }
+
+        [[nodiscard]] bool zero_copy_enabled() const noexcept {
+            return zero_copy_threshold_ > 0;
+        }
+
+        [[nodiscard]] bool zero_copy_pending() const noexcept {
+            return zero_copy_sent_ != zero_copy_completed_;
+        }
+
+    private:
+        // Either a range of storage_ (data == nullptr) or referenced bytes.
+        struct segment {
+            const std::byte* data;
+            std::size_t offset;
+            std::size_t size;
+            bool zero_copy;
+        };
+
+        // Sends segments from first_ on in one call. Returns the bytes sent, 0 if the socket would block.
+        std::size_t send_some();
+        void clear() noexcept;
+
+    private:
+        socket& socket_;
+        std::vector<std::byte> storage_;
+        std::vector<segment> segments_;
+        std::size_t first_ = 0; // The first segment not fully sent.
+        std::size_t size_ = 0;
+        std::uint64_t bytes_sent_ = 0;
+
+        // 0 while zero copy is disabled. The counters wrap around like the kernel's.
+        std::size_t zero_copy_threshold_ = 0;
+        std::uint32_t zero_copy_sent_ = 0;
+        std::uint32_t zero_copy_completed_ = 0;
+    };
+} // namespace mio::sockets
+
+#endif // INCLUDE_mio_sockets_output_buffer_hpp
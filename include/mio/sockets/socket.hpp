@@ -3,18 +3,40 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 namespace mio::sockets {
     enum class address_family : int {
+        unspecified = AF_UNSPEC,
         inet = AF_INET,
+        inet6 = AF_INET6,
+        local = AF_UNIX,
     };
 
     enum class socket_type : int {
         stream = SOCK_STREAM,
     };
 
+    enum class shutdown_type : int {
+        receive = SHUT_RD,
+        send = SHUT_WR,
+        both = SHUT_RDWR,
+    };
+
+    class endpoint;
+
+    // Zero-copy sends reported done by the kernel, numbered from 0 in the order they were made.
+    struct zero_copy_completion {
+        std::uint32_t first;
+        std::uint32_t last;
+        bool copied; // The kernel fell back to copying the data, as it does on loopback.
+    };
+
     class socket {
     private:
         explicit socket(int fd) noexcept;
@@ -23,22 +45,74 @@ namespace mio::sockets {
         socket(address_family family, socket_type type);
         ~socket() noexcept;
 
+        // Two connected, non-blocking Unix domain stream sockets: a byte stream through memory that stands in for a
+        // network connection, e.g. to run http_server::serve() in tests and benchmarks.
+        static std::pair<socket, socket> pair();
+
         // Movable
         socket(socket&& socket) noexcept;
         socket& operator=(socket&& socket);
 
+        // The setters return the result of setsockopt(2).
         int set_reuse_addr(bool value);
+        int set_keep_alive(bool value);
+        int set_send_buffer_size(int size_bytes);
+        int set_receive_buffer_size(int size_bytes);
+
+        // TCP only.
+        int set_no_delay(bool value);
+        int set_cork(bool value);
+        int set_defer_accept(int timeout_seconds);
+        int set_fast_open(int queue_length);
+
+        // IPv6 only: false accepts IPv4 clients as well.
+        int set_v6_only(bool value);
+
+        int set_non_blocking(bool value);
+
+        // SO_ZEROCOPY, which send_some_zero_copy() needs.
+        int set_zero_copy(bool value);
 
-        void listen(std::uint16_t port, int backlog = 10);
-        socket accept();
+        void listen(const endpoint& endpoint, int backlog = SOMAXCONN);
 
+        // Accepts a pending connection as a non-blocking, close-on-exec socket and stores its address in `peer`.
+        // Returns std::nullopt once the backlog of a non-blocking listener is drained.
+        std::optional<socket> accept(endpoint& peer);
+
+        // Both wait for the socket to be ready if it is non-blocking. send() sends every byte.
         std::size_t receive(void* buffer, std::size_t size_bytes);
         std::size_t send(const void* data, std::size_t size_bytes);
 
+        // Gathers `buffers` into one send without waiting. Returns the bytes sent, 0 if the socket would block.
+        std::size_t send_some(std::span<const ::iovec> buffers);
+
+        // send_some() with MSG_ZEROCOPY: the pages are handed to the device as they are and must stay unmodified
+        // until the send is reported complete. Returns std::nullopt, sending nothing, if the kernel cannot pin more
+        // pages right now.
+        std::optional<std::size_t> send_some_zero_copy(std::span<const ::iovec> buffers);
+
+        // Reads one notification from the error queue without waiting. Returns std::nullopt if there is none.
+        std::optional<zero_copy_completion> receive_zero_copy_completion();
+
+        void wait_readable();
+        void wait_writable();
+
+        // Waits for a notification on the error queue, or for the socket to be shut down.
+        void wait_error_queue();
+
+        // Safe to call from another thread: a receive blocked on the socket returns 0 and a blocked send fails.
+        void shutdown(shutdown_type how) noexcept;
+
+        [[nodiscard]] endpoint local_endpoint() const;
+
         [[nodiscard]] int descriptor() const noexcept {
             return fd_;
         }
 
+    private:
+        int set_option(int level, int name, int value);
+        void wait(short events);
+
     private:
         int fd_;
 
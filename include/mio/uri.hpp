@@ -1,6 +1,9 @@
 #ifndef INCLUDE_mio_uri_hpp
 #define INCLUDE_mio_uri_hpp
 
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -10,33 +13,94 @@ namespace mio {
         constexpr bool is_hex_digit(char c) noexcept {
             return ('0' <= c && c <= '9') || ('A' <= c && c <= 'F') || ('a' <= c && c <= 'f');
         }
+
+        constexpr std::uint8_t hex_value(char c) noexcept {
+            return (c <= '9') ? c - '0' : (c <= 'F') ? c - 'A' + 10 : c - 'a' + 10;
+        }
+
+        // Returns the index of the first '%' (or '+' if replace_plus) in s, or s.size().
+        inline std::size_t find_uri_escape(std::string_view s, bool replace_plus) noexcept {
+            std::size_t n = s.size();
+
+            if (const auto p = static_cast<const char*>(std::memchr(s.data(), '%', n))) {
+                n = static_cast<std::size_t>(p - s.data());
+            }
+            if (replace_plus) {
+                if (const auto p = static_cast<const char*>(std::memchr(s.data(), '+', n))) {
+                    n = static_cast<std::size_t>(p - s.data());
+                }
+            }
+
+            return n;
+        }
     } // namespace detail
 
-    inline std::optional<std::string> decode_uri(std::string_view s, bool replace_plus) {
-        std::string text{};
-        text.reserve(s.size());
+    // Decodes s without allocating.
+    // Returns s itself when there is nothing to decode. Otherwise decodes into `buffer`, which must have room
+    // for s.size() chars, and returns the decoded text in it. Returns std::nullopt on a malformed escape.
+    inline std::optional<std::string_view> decode_uri(std::string_view s, bool replace_plus, char* buffer) noexcept {
+        const auto find = [&](char c, std::size_t from) noexcept -> std::size_t {
+            const auto p = static_cast<const char*>(std::memchr(s.data() + from, c, s.size() - from));
+            return p != nullptr ? static_cast<std::size_t>(p - s.data()) : s.size();
+        };
+
+        // Next positions of '%' and '+', each rescanned only once passed.
+        std::size_t percent = find('%', 0);
+        std::size_t plus = replace_plus ? find('+', 0) : s.size();
+
+        if (percent == s.size() && plus == s.size()) {
+            return s;
+        }
+
+        char* out = buffer;
+        std::size_t i = 0;
+        for (;;) {
+            const auto next = std::min(percent, plus);
 
-        for (std::size_t i = 0; i < s.size();) {
-            if (s[i] == '%') {
+            // Copy the plain run before the escape in bulk.
+            std::memcpy(out, s.data() + i, next - i);
+            out += next - i;
+            i = next;
+
+            if (i == s.size()) {
+                break;
+            }
+
+            if (i == percent) {
                 if (i + 2 >= s.size() || !detail::is_hex_digit(s[i + 1]) || !detail::is_hex_digit(s[i + 2])) {
                     return std::nullopt;
                 }
 
-                const std::uint8_t hi = (s[i + 1] <= '9') ? s[i + 1] - '0' : (s[i + 1] <= 'F') ? s[i + 1] - 'A' + 10 : s[i + 1] - 'a' + 10;
-                const std::uint8_t lo = (s[i + 2] <= '9') ? s[i + 2] - '0' : (s[i + 2] <= 'F') ? s[i + 2] - 'A' + 10 : s[i + 2] - 'a' + 10;
-                const std::uint8_t byte = (hi << 4) | lo;
-
-                text += static_cast<char>(byte);
+                *out++ = static_cast<char>((detail::hex_value(s[i + 1]) << 4) | detail::hex_value(s[i + 2]));
                 i += 3;
-            } else if (s[i] == '+' && replace_plus) {
-                text += ' ';
-                i++;
             } else {
-                text += s[i];
-                i++;
+                *out++ = ' ';
+                i += 1;
+            }
+
+            if (percent < i) {
+                percent = find('%', i);
+            }
+            if (plus < i) {
+                plus = find('+', i);
             }
         }
 
+        return std::string_view{buffer, static_cast<std::size_t>(out - buffer)};
+    }
+
+    inline std::optional<std::string> decode_uri(std::string_view s, bool replace_plus) {
+        if (detail::find_uri_escape(s, replace_plus) == s.size()) {
+            return std::string{s};
+        }
+
+        std::string text(s.size(), '\0');
+        const auto decoded = decode_uri(s, replace_plus, text.data());
+        if (!decoded) {
+            return std::nullopt;
+        }
+
+        text.resize(decoded->size());
         return text;
     }
 } // namespace mio
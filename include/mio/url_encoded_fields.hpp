@@ -0,0 +1,92 @@
+#ifndef INCLUDE_mio_url_encoded_fields_hpp
+#define INCLUDE_mio_url_encoded_fields_hpp
+
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "request_error.hpp"
+
+namespace mio {
+    struct url_encoded_field {
+        std::string_view key;
+        std::string_view value;
+    };
+
+    // Fields of an "a=1&b=2" string (a query string or an x-www-form-urlencoded body), parsed on demand.
+    // Keys and values point into the source when they contain no escapes; others are decoded into one buffer
+    // sized to the source, so decoding never reallocates and never invalidates earlier fields.
+    // Moving resets the parse state since the source usually moves along with this object.
+    class url_encoded_fields {
+    public:
+        explicit url_encoded_fields(std::pmr::memory_resource* resource = std::pmr::new_delete_resource())
+            : parsed_(false)
+            , malformed_(false)
+            , fields_(resource)
+            , decoded_(resource) {
+        }
+
+        ~url_encoded_fields() noexcept = default;
+
+        // Uncopyable and movable
+        url_encoded_fields(const url_encoded_fields&) = delete;
+
+        url_encoded_fields(url_encoded_fields&& other) noexcept
+            : url_encoded_fields(other.fields_.get_allocator().resource()) {
+        }
+
+        url_encoded_fields& operator=(const url_encoded_fields&) = delete;
+
+        url_encoded_fields& operator=(url_encoded_fields&&) noexcept {
+            reset();
+            return *this;
+        }
+
+        [[nodiscard]] bool parsed() const noexcept {
+            return parsed_;
+        }
+
+        // Parses `source`, which must outlive the fields. A field with a malformed escape is left out and reported
+        // as request_error::bad_request, now and on every later call until reset.
+        request_result<void> parse(std::string_view source);
+
+        void reset() noexcept {
+            parsed_ = false;
+            malformed_ = false;
+            fields_.clear();
+            decoded_.clear();
+        }
+
+        [[nodiscard]] std::span<const url_encoded_field> entries() const noexcept {
+            return fields_;
+        }
+
+        [[nodiscard]] std::optional<std::string_view> get(std::string_view key) const noexcept {
+            for (const auto& field : fields_) {
+                if (field.key == key) {
+                    return field.value;
+                }
+            }
+            return std::nullopt;
+        }
+
+        [[nodiscard]] auto get_all(std::string_view key) const noexcept {
+            return entries()
+                   | std::views::filter([key](const url_encoded_field& field) { return field.key == key; })
+                   | std::views::transform(&url_encoded_field::value);
+        }
+
+    private:
+        void parse_fields(std::string_view source);
+
+    private:
+        bool parsed_;
+        bool malformed_;
+        std::pmr::vector<url_encoded_field> fields_;
+        std::pmr::vector<char> decoded_;
+    };
+} // namespace mio
+
+#endif // INCLUDE_mio_url_encoded_fields_hpp
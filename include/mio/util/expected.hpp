@@ -0,0 +1,127 @@
+#ifndef INCLUDE_mio_util_expected_hpp
+#define INCLUDE_mio_util_expected_hpp
+
+#include <cassert>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace mio::util {
+    // The error alternative of an expected, as in `return util::unexpected{request_error::bad_request};`.
+    template <typename E>
+    class unexpected {
+    public:
+        constexpr explicit unexpected(E error) noexcept(std::is_nothrow_move_constructible_v<E>)
+            : error_(std::move(error)) {
+        }
+
+        [[nodiscard]] constexpr const E& error() const noexcept {
+            return error_;
+        }
+
+    private:
+        E error_;
+    };
+
+    // Either a value or an error, for failures that are expected often enough that throwing would cost too much.
+    // The subset of C++23 std::expected that this library uses, to be replaced by it.
+    template <typename T, typename E>
+    class [[nodiscard]] expected {
+    public:
+        constexpr expected() requires std::is_default_constructible_v<T>
+            : storage_(std::in_place_index<0>) {
+        }
+
+        template <typename U = T>
+        requires std::is_constructible_v<T, U&&> && (!std::is_same_v<std::remove_cvref_t<U>, expected>)
+        constexpr expected(U&& value)
+            : storage_(std::in_place_index<0>, std::forward<U>(value)) {
+        }
+
+        constexpr expected(unexpected<E> error)
+            : storage_(std::in_place_index<1>, error.error()) {
+        }
+
+        [[nodiscard]] constexpr bool has_value() const noexcept {
+            return storage_.index() == 0;
+        }
+
+        constexpr explicit operator bool() const noexcept {
+            return has_value();
+        }
+
+        [[nodiscard]] constexpr T& value() & noexcept {
+            assert(has_value());
+            return *std::get_if<0>(&storage_);
+        }
+
+        [[nodiscard]] constexpr const T& value() const& noexcept {
+            assert(has_value());
+            return *std::get_if<0>(&storage_);
+        }
+
+        [[nodiscard]] constexpr T&& value() && noexcept {
+            assert(has_value());
+            return std::move(*std::get_if<0>(&storage_));
+        }
+
+        [[nodiscard]] constexpr const E& error() const noexcept {
+            assert(!has_value());
+            return *std::get_if<1>(&storage_);
+        }
+
+        constexpr T& operator*() & noexcept {
+            return value();
+        }
+
+        constexpr const T& operator*() const& noexcept {
+            return value();
+        }
+
+        constexpr T&& operator*() && noexcept {
+            return std::move(*this).value();
+        }
+
+        constexpr T* operator->() noexcept {
+            return &value();
+        }
+
+        constexpr const T* operator->() const noexcept {
+            return &value();
+        }
+
+    private:
+        std::variant<T, E> storage_;
+    };
+
+    // Success without a value, or an error.
+    template <typename E>
+    class [[nodiscard]] expected<void, E> {
+    public:
+        constexpr expected() noexcept = default;
+
+        constexpr expected(unexpected<E> error)
+            : error_(error.error())
+            , has_value_(false) {
+        }
+
+        [[nodiscard]] constexpr bool has_value() const noexcept {
+            return has_value_;
+        }
+
+        constexpr explicit operator bool() const noexcept {
+            return has_value_;
+        }
+
+        [[nodiscard]] constexpr const E& error() const noexcept {
+            assert(!has_value_);
+            return error_;
+        }
+
+    private:
+        E error_{};
+        bool has_value_ = true;
+    };
+} // namespace mio::util
+
+#endif // INCLUDE_mio_util_expected_hpp
@@ -0,0 +1,71 @@
+#ifndef INCLUDE_mio_util_hdr_histogram_hpp
+#define INCLUDE_mio_util_hdr_histogram_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mio::util {
+    // Counts of non-negative integers (e.g. latencies in nanoseconds) in log-linear buckets, after HdrHistogram.
+    // Values below 2048 are exact; larger ones share a bucket with values within 1/1024 of them, so percentiles keep
+    // three significant digits at any magnitude. Recording is O(1) and never allocates.
+    // Not thread-safe: record into one histogram per thread and merge them.
+    class hdr_histogram {
+    public:
+        static constexpr std::size_t sub_bucket_bits = 11;
+        static constexpr std::uint64_t sub_bucket_count = std::uint64_t{1} << sub_bucket_bits;
+
+        // Larger values are clamped to `highest_value`. The default is about 18 minutes in nanoseconds.
+        explicit hdr_histogram(std::uint64_t highest_value = std::uint64_t{1} << 40);
+        ~hdr_histogram() noexcept = default;
+
+        // Copyable and movable
+        hdr_histogram(const hdr_histogram&) = default;
+        hdr_histogram(hdr_histogram&&) = default;
+
+        hdr_histogram& operator=(const hdr_histogram&) = default;
+        hdr_histogram& operator=(hdr_histogram&&) = default;
+
+        void record(std::uint64_t value, std::uint64_t count = 1) noexcept;
+
+        // Adds the counts of `other`, whose highest value must not exceed this one's.
+        void merge(const hdr_histogram& other) noexcept;
+
+        void reset() noexcept;
+
+        [[nodiscard]] std::uint64_t count() const noexcept {
+            return total_;
+        }
+
+        [[nodiscard]] std::uint64_t min() const noexcept {
+            return total_ > 0 ? min_ : 0;
+        }
+
+        [[nodiscard]] std::uint64_t max() const noexcept {
+            return max_;
+        }
+
+        [[nodiscard]] double mean() const noexcept {
+            return total_ > 0 ? sum_ / static_cast<double>(total_) : 0.0;
+        }
+
+        // The smallest recorded value that `percentile` percent of the values are at or below, as the highest value
+        // of its bucket. percentile(50) is the median and percentile(100) the maximum.
+        [[nodiscard]] std::uint64_t percentile(double percentile) const noexcept;
+
+        // Bucket arithmetic, exposed for tests.
+        [[nodiscard]] static std::size_t index_of(std::uint64_t value) noexcept;
+        [[nodiscard]] static std::uint64_t lowest_equivalent(std::size_t index) noexcept;
+        [[nodiscard]] static std::uint64_t highest_equivalent(std::size_t index) noexcept;
+
+    private:
+        std::uint64_t highest_value_;
+        std::vector<std::uint64_t> counts_;
+        std::uint64_t total_;
+        std::uint64_t min_;
+        std::uint64_t max_;
+        double sum_;
+    };
+} // namespace mio::util
+
+#endif // INCLUDE_mio_util_hdr_histogram_hpp
@@ -0,0 +1,28 @@
+#ifndef INCLUDE_mio_util_path_hpp
+#define INCLUDE_mio_util_path_hpp
+
+#include <string>
+#include <string_view>
+
+namespace mio::util {
+    // Normalizes a path prefix to "" or "/foo/bar".
+    inline std::string normalize_prefix(std::string_view path) {
+        std::string prefix{};
+        if (!path.starts_with('/')) {
+            prefix += '/';
+        }
+        prefix += path;
+        while (prefix.ends_with('/')) {
+            prefix.pop_back();
+        }
+        return prefix;
+    }
+
+    // Returns true if `path` is `prefix` itself or lies under it.
+    // "/assets" matches "/assets" and "/assets/x", but not "/assetsx".
+    constexpr bool has_path_prefix(std::string_view path, std::string_view prefix) noexcept {
+        return path.starts_with(prefix) && (path.size() == prefix.size() || path[prefix.size()] == '/');
+    }
+} // namespace mio::util
+
+#endif // INCLUDE_mio_util_path_hpp
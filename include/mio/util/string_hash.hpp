@@ -0,0 +1,18 @@
+#ifndef INCLUDE_mio_util_string_hash_hpp
+#define INCLUDE_mio_util_string_hash_hpp
+
+#include <functional>
+#include <string_view>
+
+namespace mio::util {
+    // Transparent hash so that unordered containers keyed by strings can be looked up by std::string_view.
+    struct string_hash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view s) const noexcept {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+} // namespace mio::util
+
+#endif // INCLUDE_mio_util_string_hash_hpp
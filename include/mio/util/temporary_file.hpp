@@ -0,0 +1,13 @@
+#ifndef INCLUDE_mio_util_temporary_file_hpp
+#define INCLUDE_mio_util_temporary_file_hpp
+
+#include <string>
+#include "unique_fd.hpp"
+
+namespace mio::util {
+    // Opens an unnamed file in `directory` for reading and writing, which disappears once closed.
+    // It can be given a name with linkat(2) through /proc/self/fd. Throws std::system_error on failure.
+    unique_fd open_temporary_file(const std::string& directory);
+} // namespace mio::util
+
+#endif // INCLUDE_mio_util_temporary_file_hpp
@@ -0,0 +1,99 @@
+#ifndef INCLUDE_mio_util_timer_wheel_hpp
+#define INCLUDE_mio_util_timer_wheel_hpp
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace mio::util {
+    // Hierarchical timing wheel: 4 levels of 64 slots, each level 64 times coarser than the one below.
+    // Scheduling and cancelling are O(1); advancing visits one slot per tick and now and then cascades the timers of
+    // a coarser slot down. Deadlines are rounded up to whole ticks, so timers never fire early.
+    // Not thread-safe.
+    class timer_wheel {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        // Intrusive entry; it must be cancelled (or have fired) before it is destroyed.
+        class timer {
+        public:
+            explicit timer(std::function<void()> callback)
+                : callback_(std::move(callback)) {
+            }
+
+            ~timer() noexcept = default;
+
+            [[nodiscard]] bool is_scheduled() const noexcept {
+                return pprev_ != nullptr;
+            }
+
+        private:
+            friend class timer_wheel;
+
+            std::function<void()> callback_;
+            timer* next_ = nullptr;
+            timer** pprev_ = nullptr;
+            std::uint64_t expiry_ = 0;
+
+        private:
+            // Uncopyable and unmovable
+            timer(const timer&) = delete;
+            timer(timer&&) = delete;
+
+            timer& operator=(const timer&) = delete;
+            timer& operator=(timer&&) = delete;
+        };
+
+        static constexpr std::size_t level_bits = 6;
+        static constexpr std::size_t slots_per_level = std::size_t{1} << level_bits;
+        static constexpr std::size_t levels = 4;
+
+        // Farther deadlines are clamped to this many ticks.
+        static constexpr std::uint64_t max_ticks = std::uint64_t{1} << (level_bits * levels);
+
+        timer_wheel(clock::duration resolution, clock::time_point now) noexcept;
+        ~timer_wheel() noexcept;
+
+        // (Re)schedules `t` to fire at the first tick at or after `deadline`, and at the earliest on the next tick.
+        void schedule(timer& t, clock::time_point deadline) noexcept;
+        void cancel(timer& t) noexcept;
+
+        // Fires every timer whose deadline has passed by `now`. Returns the number of timers fired.
+        std::size_t advance(clock::time_point now);
+
+        [[nodiscard]] std::size_t size() const noexcept {
+            return size_;
+        }
+
+        [[nodiscard]] clock::duration resolution() const noexcept {
+            return resolution_;
+        }
+
+    private:
+        [[nodiscard]] std::uint64_t to_ticks(clock::time_point time, bool round_up) const noexcept;
+
+        void place(timer& t) noexcept;
+        void cascade(std::size_t level, std::size_t index) noexcept;
+
+        static void link(timer*& head, timer& t) noexcept;
+        static void unlink(timer& t) noexcept;
+
+    private:
+        clock::duration resolution_;
+        clock::time_point origin_;
+        std::uint64_t now_ = 0;
+        std::size_t size_ = 0;
+        timer* slots_[levels][slots_per_level] = {};
+
+    private:
+        // Uncopyable and unmovable
+        timer_wheel(const timer_wheel&) = delete;
+        timer_wheel(timer_wheel&&) = delete;
+
+        timer_wheel& operator=(const timer_wheel&) = delete;
+        timer_wheel& operator=(timer_wheel&&) = delete;
+    };
+} // namespace mio::util
+
+#endif // INCLUDE_mio_util_timer_wheel_hpp
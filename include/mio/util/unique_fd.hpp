@@ -0,0 +1,62 @@
+#ifndef INCLUDE_mio_util_unique_fd_hpp
+#define INCLUDE_mio_util_unique_fd_hpp
+
+#include <utility>
+
+#include <unistd.h>
+
+namespace mio::util {
+    // Owns a file descriptor and closes it on destruction.
+    class unique_fd {
+    public:
+        unique_fd() noexcept
+            : fd_(-1) {
+        }
+
+        explicit unique_fd(int fd) noexcept
+            : fd_(fd) {
+        }
+
+        ~unique_fd() noexcept {
+            reset();
+        }
+
+        // Uncopyable and movable
+        unique_fd(const unique_fd&) = delete;
+
+        unique_fd(unique_fd&& other) noexcept
+            : fd_(other.release()) {
+        }
+
+        unique_fd& operator=(const unique_fd&) = delete;
+
+        unique_fd& operator=(unique_fd&& other) noexcept {
+            reset(other.release());
+            return *this;
+        }
+
+        [[nodiscard]] int get() const noexcept {
+            return fd_;
+        }
+
+        explicit operator bool() const noexcept {
+            return fd_ >= 0;
+        }
+
+        int release() noexcept {
+            return std::exchange(fd_, -1);
+        }
+
+        void reset(int fd = -1) noexcept {
+            if (fd_ >= 0) {
+                ::close(fd_);
+            }
+            fd_ = fd;
+        }
+
+    private:
+        int fd_;
+    };
+} // namespace mio::util
+
+#endif // INCLUDE_mio_util_unique_fd_hpp
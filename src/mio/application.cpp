@@ -1,27 +1,61 @@
 #include "mio/application.hpp"
 
+#include "mio/http_request.hpp"
 #include "mio/http_response.hpp"
+#include "mio/util/path.hpp"
 
 namespace mio {
-    http_response application_base::on_request(http_request& req) {
-        auto res = get_router().handle_request(req);
-        if (!res) {
-            res = on_routing_not_found(req);
+    http_response next_handler::operator()(http_request& req) const {
+        return app_.dispatch(req, index_);
+    }
+
+    std::optional<http_response> application::on_headers([[maybe_unused]] http_request& req, [[maybe_unused]] route_options& options) {
+        return std::nullopt;
+    }
+
+    http_response application::on_request_error(request_error error) noexcept {
+        switch (error) {
+            case request_error::payload_too_large:
+                return http_response::html(413, "413 Request Entity Too Large");
+            case request_error::header_fields_too_large:
+                return http_response::html(431, "431 Request Header Fields Too Large");
+            case request_error::http_version_not_supported:
+                return http_response::html(505, "505 HTTP Version Not Supported");
+            case request_error::bad_request:
+                break;
         }
+        return http_response::html(400, "400 Bad Request");
+    }
 
-        for (const auto& middleware : middlewares_) {
-            middleware(req, *res);
+    std::optional<http_response> application_base::on_headers(http_request& req, route_options& options) {
+        auto found = get_router().find_options(req);
+        if (!found) {
+            return on_request_error(found.error());
         }
 
-        return std::move(*res);
+        options = std::move(*found);
+
+        for (const auto& [prefix, middleware] : before_body_middlewares_) {
+            if (util::has_path_prefix(req.path(), prefix)) {
+                if (auto res = middleware(req)) {
+                    return res;
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    http_response application_base::on_request(http_request& req) {
+        return dispatch(req, 0);
     }
 
     http_response application_base::on_routing_not_found([[maybe_unused]] http_request& req) {
         return http_response::html(404, "404 not found");
     }
 
-    http_response application_base::on_error(const std::exception& e) noexcept {
-        return http_response::html(404, e.what());
+    http_response application_base::on_error([[maybe_unused]] const std::exception& e) noexcept {
+        return http_response::html(500, "500 Internal Server Error");
     }
 
     http_response application_base::on_unknown_error() noexcept {
@@ -29,6 +63,81 @@ namespace mio {
     }
 
     void application_base::use(middleware&& middleware) {
-        middlewares_.emplace_back(std::move(middleware));
+        after(std::move(middleware));
+    }
+
+    void application_base::before(before_middleware&& middleware) {
+        before_middlewares_.emplace_back(scoped_middleware<before_middleware>{"", std::move(middleware)});
+    }
+
+    void application_base::before(std::string_view prefix, before_middleware&& middleware) {
+        before_middlewares_.emplace_back(scoped_middleware<before_middleware>{util::normalize_prefix(prefix), std::move(middleware)});
+    }
+
+    void application_base::before_body(before_middleware&& middleware) {
+        before_body_middlewares_.emplace_back(scoped_middleware<before_middleware>{"", std::move(middleware)});
+    }
+
+    void application_base::before_body(std::string_view prefix, before_middleware&& middleware) {
+        before_body_middlewares_.emplace_back(scoped_middleware<before_middleware>{util::normalize_prefix(prefix), std::move(middleware)});
+    }
+
+    void application_base::after(middleware&& middleware) {
+        after_middlewares_.emplace_back(scoped_middleware<mio::middleware>{"", std::move(middleware)});
+    }
+
+    void application_base::after(std::string_view prefix, middleware&& middleware) {
+        after_middlewares_.emplace_back(scoped_middleware<mio::middleware>{util::normalize_prefix(prefix), std::move(middleware)});
+    }
+
+    void application_base::around(around_middleware&& middleware) {
+        around_middlewares_.emplace_back(scoped_middleware<around_middleware>{"", std::move(middleware)});
+    }
+
+    void application_base::around(std::string_view prefix, around_middleware&& middleware) {
+        around_middlewares_.emplace_back(scoped_middleware<around_middleware>{util::normalize_prefix(prefix), std::move(middleware)});
+    }
+
+    http_response application_base::dispatch(http_request& req, std::size_t index) {
+        for (; index < around_middlewares_.size(); index++) {
+            const auto& [prefix, middleware] = around_middlewares_[index];
+            if (util::has_path_prefix(req.path(), prefix)) {
+                return middleware(req, next_handler{*this, index + 1});
+            }
+        }
+
+        return handle(req);
+    }
+
+    http_response application_base::handle(http_request& req) {
+        std::optional<http_response> res{};
+
+        for (const auto& [prefix, middleware] : before_middlewares_) {
+            if (util::has_path_prefix(req.path(), prefix)) {
+                if ((res = middleware(req))) {
+                    break;
+                }
+            }
+        }
+
+        if (!res) {
+            if (auto handled = get_router().handle_request(req)) {
+                res = std::move(*handled);
+            } else {
+                res = on_request_error(handled.error());
+            }
+        }
+
+        if (!res) {
+            res = on_routing_not_found(req);
+        }
+
+        for (const auto& [prefix, middleware] : after_middlewares_) {
+            if (util::has_path_prefix(req.path(), prefix)) {
+                middleware(req, *res);
+            }
+        }
+
+        return std::move(*res);
     }
 } // namespace mio
@@ -0,0 +1,458 @@
+#include "mio/bodies/multipart.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "mio/http_request.hpp"
+#include "mio/request_error.hpp"
+#include "mio/util/trim.hpp"
+
+namespace mio::bodies {
+    namespace {
+        constexpr bool iequals(std::string_view a, std::string_view b) noexcept {
+            return std::ranges::equal(a, b, [](char x, char y) {
+                return ('A' <= x && x <= 'Z' ? x | 0x20 : x) == ('A' <= y && y <= 'Z' ? y | 0x20 : y);
+            });
+        }
+
+        // Returns the value of `key` in a "type; key=value; key="quoted value"" header, unquoted.
+        std::optional<std::string> header_parameter(std::string_view header, std::string_view key) {
+            std::size_t pos = header.find(';');
+            while (pos != std::string_view::npos) {
+                const auto next = header.find(';', pos + 1);
+                const auto param = util::trim(header.substr(pos + 1, next == std::string_view::npos ? std::string_view::npos : next - pos - 1));
+                pos = next;
+
+                const auto eq = param.find('=');
+                if (eq == std::string_view::npos || !iequals(util::trim(param.substr(0, eq)), key)) {
+                    continue;
+                }
+
+                auto value = util::trim(param.substr(eq + 1));
+                if (!value.starts_with('"')) {
+                    return std::string{value};
+                }
+
+                // Quoted string: may contain ';' and backslash escapes.
+                const auto start = value.data() + 1;
+                const auto end = header.data() + header.size();
+
+                std::string unquoted{};
+                for (auto p = start; p != end; p++) {
+                    if (*p == '"') {
+                        return unquoted;
+                    }
+                    if (*p == '\\' && p + 1 != end) {
+                        p++;
+                    }
+                    unquoted += *p;
+                }
+                return std::nullopt;
+            }
+
+            return std::nullopt;
+        }
+
+        void write_all(int fd, std::span<const std::byte> data) {
+            while (!data.empty()) {
+                const auto written = ::write(fd, data.data(), data.size());
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::system_error{errno, std::generic_category()};
+                }
+                data = data.subspan(static_cast<std::size_t>(written));
+            }
+        }
+    } // namespace
+
+    std::optional<std::string_view> multipart_boundary(const http_headers& headers) {
+        const auto content_type = headers.get("content-type");
+        if (!content_type) {
+            return std::nullopt;
+        }
+
+        if (!iequals(util::trim(content_type->substr(0, content_type->find(';'))), "multipart/form-data")) {
+            return std::nullopt;
+        }
+
+        // The boundary is a token or a quoted string without escapes (RFC 2046).
+        const auto pos = content_type->find("boundary=");
+        if (pos == std::string_view::npos) {
+            return std::nullopt;
+        }
+
+        auto boundary = content_type->substr(pos + 9);
+        if (boundary.starts_with('"')) {
+            boundary.remove_prefix(1);
+            boundary = boundary.substr(0, boundary.find('"'));
+        } else {
+            boundary = util::trim(boundary.substr(0, boundary.find(';')));
+        }
+
+        if (boundary.empty() || boundary.size() > 70) {
+            return std::nullopt;
+        }
+
+        return boundary;
+    }
+
+    multipart_parser::multipart_parser(std::string_view boundary, multipart_handler& handler)
+        : handler_(handler)
+        , delimiter_()
+        , skip_()
+        , state_(state::preamble)
+        , carry_()
+        , header_buffer_() {
+        delimiter_ = "\r\n--";
+        delimiter_ += boundary;
+
+        // Bad character table of Boyer-Moore-Horspool.
+        skip_.fill(delimiter_.size());
+        for (std::size_t i = 0; i + 1 < delimiter_.size(); i++) {
+            skip_[static_cast<unsigned char>(delimiter_[i])] = delimiter_.size() - 1 - i;
+        }
+
+        // The first delimiter may be at the very beginning of the body, without the leading CRLF.
+        carry_ = "\r\n";
+    }
+
+    std::size_t multipart_parser::find_delimiter(std::string_view haystack) const noexcept {
+        const auto n = delimiter_.size();
+        const auto last = delimiter_.back();
+
+        for (std::size_t i = 0; i + n <= haystack.size();) {
+            const auto c = haystack[i + n - 1];
+            if (c == last && std::memcmp(haystack.data() + i, delimiter_.data(), n - 1) == 0) {
+                return i;
+            }
+            i += skip_[static_cast<unsigned char>(c)];
+        }
+
+        return std::string_view::npos;
+    }
+
+    void multipart_parser::emit(std::string_view data) {
+        if (state_ == state::part_body && !data.empty()) {
+            handler_.on_part_data(std::as_bytes(std::span{data}));
+        }
+    }
+
+    void multipart_parser::end_body() {
+        if (state_ == state::part_body) {
+            handler_.on_part_end();
+        }
+        carry_.clear();
+        state_ = state::delimiter_tail;
+    }
+
+    std::size_t multipart_parser::feed_body(std::string_view data) {
+        const auto n = delimiter_.size();
+
+        if (!carry_.empty()) {
+            // A delimiter may start in the carried bytes and continue in data.
+            const auto carried = carry_.size();
+            const auto borrowed = std::min(data.size(), n - 1);
+            carry_.append(data.substr(0, borrowed));
+
+            const auto pos = find_delimiter(carry_);
+            if (pos != std::string_view::npos && pos < carried) {
+                emit(std::string_view{carry_}.substr(0, pos));
+                end_body();
+                return pos + n - carried;
+            }
+
+            // Only the positions followed by a whole delimiter's worth of bytes have been ruled out.
+            const auto checked = carry_.size() >= n ? std::min(carried, carry_.size() - n + 1) : 0;
+            if (checked < carried) {
+                // All of data was borrowed; keep what may still begin a delimiter.
+                emit(std::string_view{carry_}.substr(0, checked));
+                carry_.erase(0, checked);
+                return borrowed;
+            }
+
+            emit(std::string_view{carry_}.substr(0, carried));
+            carry_.clear();
+        }
+
+        if (const auto pos = find_delimiter(data); pos != std::string_view::npos) {
+            emit(data.substr(0, pos));
+            end_body();
+            return pos + n;
+        }
+
+        // Hold back the bytes which may begin a delimiter.
+        const auto keep = std::min(data.size(), n - 1);
+        emit(data.substr(0, data.size() - keep));
+        carry_.assign(data.substr(data.size() - keep));
+        return data.size();
+    }
+
+    std::size_t multipart_parser::feed_delimiter_tail(std::string_view data) {
+        // After a delimiter: "--" closes the body; otherwise optional whitespace and CRLF begin the next part.
+        constexpr std::size_t max_padding = 64;
+
+        for (std::size_t i = 0; i < data.size();) {
+            const char c = data[i++];
+            carry_ += c;
+
+            if (carry_.front() == '-') {
+                if (c != '-') {
+                    throw request_error_exception{request_error::bad_request};
+                }
+                if (carry_.size() == 2) {
+                    carry_.clear();
+                    state_ = state::epilogue;
+                    return i;
+                }
+            } else if (carry_.ends_with("\r\n")) {
+                carry_.clear();
+                state_ = state::part_headers;
+                return i;
+            } else if ((c != ' ' && c != '\t' && c != '\r') || carry_.ends_with("\r\r") || carry_.size() > max_padding) {
+                throw request_error_exception{request_error::bad_request};
+            }
+        }
+
+        return data.size();
+    }
+
+    std::size_t multipart_parser::feed_part_headers(std::string_view data) {
+        const auto previous = header_buffer_.size();
+        header_buffer_.append(data.substr(0, std::min(data.size(), max_part_header_size + 4 - previous)));
+
+        // The header block ends with an empty line; a part may have no headers at all.
+        std::size_t end;
+        if (header_buffer_.starts_with("\r\n")) {
+            end = 0;
+        } else if (const auto pos = header_buffer_.find("\r\n\r\n"); pos != std::string::npos) {
+            end = pos + 2;
+        } else {
+            if (header_buffer_.size() > max_part_header_size) {
+                throw request_error_exception{request_error::bad_request};
+            }
+            return data.size();
+        }
+
+        http_headers headers{};
+        for (std::string_view block = std::string_view{header_buffer_}.substr(0, end); !block.empty();) {
+            const auto eol = block.find("\r\n");
+            const auto line = block.substr(0, eol);
+            block.remove_prefix(eol + 2);
+
+            const auto colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                throw request_error_exception{request_error::bad_request};
+            }
+
+            if (!headers.try_append(util::trim(line.substr(0, colon)), util::trim(line.substr(colon + 1)))) {
+                throw request_error_exception{request_error::bad_request};
+            }
+        }
+
+        const auto consumed = end + 2 - previous;
+        header_buffer_.clear();
+        state_ = state::part_body;
+
+        handler_.on_part_begin(headers);
+        return consumed;
+    }
+
+    void multipart_parser::feed(std::span<const std::byte> bytes) {
+        std::string_view data{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+
+        while (!data.empty()) {
+            switch (state_) {
+                case state::preamble:
+                case state::part_body:
+                    data.remove_prefix(feed_body(data));
+                    break;
+
+                case state::delimiter_tail:
+                    data.remove_prefix(feed_delimiter_tail(data));
+                    break;
+
+                case state::part_headers:
+                    data.remove_prefix(feed_part_headers(data));
+                    break;
+
+                case state::epilogue:
+                    return;
+            }
+        }
+    }
+
+    multipart_file::multipart_file(std::string name, std::string filename, std::string content_type, std::filesystem::path path)
+        : name_(std::move(name))
+        , filename_(std::move(filename))
+        , content_type_(std::move(content_type))
+        , path_(std::move(path))
+        , size_(0) {
+    }
+
+    multipart_file::~multipart_file() noexcept {
+        if (!path_.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(path_, ec);
+        }
+    }
+
+    multipart_file::multipart_file(multipart_file&& other) noexcept
+        : name_(std::move(other.name_))
+        , filename_(std::move(other.filename_))
+        , content_type_(std::move(other.content_type_))
+        , path_(std::exchange(other.path_, {}))
+        , size_(other.size_) {
+    }
+
+    multipart_file& multipart_file::operator=(multipart_file&& other) noexcept {
+        if (this != &other) {
+            if (!path_.empty()) {
+                std::error_code ec;
+                std::filesystem::remove(path_, ec);
+            }
+
+            name_ = std::move(other.name_);
+            filename_ = std::move(other.filename_);
+            content_type_ = std::move(other.content_type_);
+            path_ = std::exchange(other.path_, {});
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    void multipart_file::persist(const std::filesystem::path& to) {
+        std::filesystem::rename(path_, to);
+        path_.clear();
+    }
+
+    multipart_form::multipart_form(multipart_options options)
+        : options_(std::move(options))
+        , fields_()
+        , files_()
+        , kind_(part_kind::field)
+        , fd_()
+        , sink_()
+        , file_count_(0)
+        , total_field_size_(0) {
+        if (options_.temp_directory.empty()) {
+            options_.temp_directory = std::filesystem::temp_directory_path();
+        }
+    }
+
+    multipart_form::~multipart_form() noexcept = default;
+
+    std::optional<std::string_view> multipart_form::field(std::string_view name) const noexcept {
+        for (const auto& [key, value] : fields_) {
+            if (key == name) {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    const multipart_file* multipart_form::file(std::string_view name) const noexcept {
+        for (const auto& f : files_) {
+            if (f.name() == name) {
+                return &f;
+            }
+        }
+        return nullptr;
+    }
+
+    void multipart_form::on_part_begin(const http_headers& headers) {
+        const auto disposition = headers.get("content-disposition").value_or("");
+        auto name = header_parameter(disposition, "name").value_or("");
+        auto filename = header_parameter(disposition, "filename");
+
+        if (!filename) {
+            if (fields_.size() >= options_.max_fields) {
+                throw request_error_exception{request_error::payload_too_large};
+            }
+
+            kind_ = part_kind::field;
+            fields_.emplace_back(std::move(name), std::string{});
+            return;
+        }
+
+        if (file_count_ >= options_.max_files) {
+            throw request_error_exception{request_error::payload_too_large};
+        }
+        file_count_++;
+
+        const std::string content_type{headers.get("content-type").value_or("application/octet-stream")};
+
+        if (options_.open_file) {
+            kind_ = part_kind::sink;
+            sink_ = options_.open_file(multipart_part{name, *filename, content_type});
+            return;
+        }
+
+        auto path = (options_.temp_directory / "mio-upload-XXXXXX").native();
+        const int fd = ::mkostemp(path.data(), O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error{errno, std::generic_category()};
+        }
+
+        kind_ = part_kind::temp_file;
+        fd_.reset(fd);
+        files_.emplace_back(std::move(name), std::move(*filename), content_type, std::move(path));
+    }
+
+    void multipart_form::on_part_data(std::span<const std::byte> data) {
+        switch (kind_) {
+            case part_kind::field: {
+                auto& value = fields_.back().second;
+                if (value.size() + data.size() > options_.max_field_size || total_field_size_ + data.size() > options_.max_total_field_size) {
+                    throw request_error_exception{request_error::payload_too_large};
+                }
+                value.append(reinterpret_cast<const char*>(data.data()), data.size());
+                total_field_size_ += data.size();
+                break;
+            }
+
+            case part_kind::temp_file:
+                write_all(fd_.get(), data);
+                files_.back().size_ += data.size();
+                break;
+
+            case part_kind::sink:
+                if (sink_) {
+                    sink_(data);
+                }
+                break;
+        }
+    }
+
+    void multipart_form::on_part_end() {
+        fd_.reset();
+        sink_ = nullptr;
+        kind_ = part_kind::field;
+    }
+
+    multipart_form parse_multipart(http_request& req, multipart_options options) {
+        const auto boundary = multipart_boundary(req.headers());
+        if (!boundary) {
+            throw request_error_exception{request_error::bad_request};
+        }
+
+        multipart_form form{std::move(options)};
+        multipart_parser parser{*boundary, form};
+        req.read_body([&](std::span<const std::byte> chunk) {
+            parser.feed(chunk);
+        });
+
+        if (!parser.done()) {
+            throw request_error_exception{request_error::bad_request};
+        }
+
+        return form;
+    }
+} // namespace mio::bodies
@@ -1,34 +1,19 @@
 #include "mio/bodies/x_www_form_url_encoded.hpp"
 
-#include <algorithm>
-
-#include "mio/http_request.hpp"
-#include "mio/uri.hpp"
+#include "mio/http_headers.hpp"
+#include "mio/url_encoded_fields.hpp"
+#include "mio/util/trim.hpp"
 
 namespace mio::bodies {
-    void parse_x_www_form_url_encoded(http_request& req) {
-        const auto body = req.body_as_text();
-
-        std::size_t pos = 0;
-        std::size_t amp;
-        do {
-            amp = body.find('&', pos);
-            const auto expr = body.substr(pos, amp);
-            const auto sep = expr.find('=');
-
-            const auto key = expr.substr(0, sep);
-            const auto value = sep != std::string_view::npos ? expr.substr(sep + 1) : std::string_view{};
-
-            auto decoded_key = decode_uri(key, true);
-            auto decoded_value = decode_uri(value, true);
-
-            if (!decoded_key || !decoded_value) {
-                throw std::runtime_error{"bad request"};
-            }
-
-            req.set_form(std::move(*decoded_key), std::move(*decoded_value));
+    bool is_x_www_form_url_encoded(const http_headers& headers) {
+        if (const auto content_type = headers.get("content-type")) {
+            const auto type = util::trim(content_type->substr(0, content_type->find(';')));
+            return type == "application/x-www-form-urlencoded";
+        }
+        return false;
+    }
 
-            pos = amp + 1;
-        } while (amp != std::string_view::npos);
+    request_result<void> parse_x_www_form_url_encoded(std::string_view body, url_encoded_fields& fields) {
+        return fields.parse(body);
     }
 } // namespace mio::bodies
@@ -0,0 +1,158 @@
+#include "mio/http1/chunked.hpp"
+
+#include <cstring>
+#include <algorithm>
+#include <charconv>
+
+namespace mio::http1 {
+    namespace {
+        constexpr int hex_value(std::byte b) noexcept {
+            const auto c = static_cast<char>(b);
+            if ('0' <= c && c <= '9') {
+                return c - '0';
+            }
+            if ('A' <= c && c <= 'F') {
+                return c - 'A' + 10;
+            }
+            if ('a' <= c && c <= 'f') {
+                return c - 'a' + 10;
+            }
+            return -1;
+        }
+    } // namespace
+
+    parse_result chunked_decoder::decode(std::span<std::byte> buffer, std::size_t& size, std::size_t& consumed) noexcept {
+        size = 0;
+        consumed = 0;
+
+        while (consumed < buffer.size()) {
+            if (state_ == state::data) {
+                // Move the chunk data down over the framing already consumed.
+                const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(chunk_size_, buffer.size() - consumed));
+                if (size != consumed) {
+                    std::memmove(buffer.data() + size, buffer.data() + consumed, n);
+                }
+
+                size += n;
+                consumed += n;
+                chunk_size_ -= n;
+
+                if (chunk_size_ == 0) {
+                    state_ = state::data_cr;
+                }
+                continue;
+            }
+
+            const auto b = buffer[consumed++];
+            const auto c = static_cast<char>(b);
+
+            switch (state_) {
+                case state::size:
+                    if (const auto v = hex_value(b); v >= 0) {
+                        if (++size_digits_ > 15) {
+                            return parse_result::invalid; // Too large.
+                        }
+                        chunk_size_ = (chunk_size_ << 4) | static_cast<std::uint64_t>(v);
+                    } else if (size_digits_ == 0) {
+                        return parse_result::invalid;
+                    } else if (c == '\r') {
+                        state_ = state::size_lf;
+                    } else if (c == ';' || c == ' ' || c == '\t') {
+                        line_size_ = 0;
+                        state_ = state::extension;
+                    } else {
+                        return parse_result::invalid;
+                    }
+                    break;
+
+                case state::extension:
+                    // Chunk extensions are ignored.
+                    if (c == '\r') {
+                        state_ = state::size_lf;
+                    } else if (++line_size_ > max_line_size) {
+                        return parse_result::invalid;
+                    }
+                    break;
+
+                case state::size_lf:
+                    if (c != '\n') {
+                        return parse_result::invalid;
+                    }
+
+                    size_digits_ = 0;
+                    line_size_ = 0;
+                    state_ = chunk_size_ == 0 ? state::trailer : state::data;
+                    break;
+
+                case state::data_cr:
+                    if (c != '\r') {
+                        return parse_result::invalid;
+                    }
+                    state_ = state::data_lf;
+                    break;
+
+                case state::data_lf:
+                    if (c != '\n') {
+                        return parse_result::invalid;
+                    }
+                    state_ = state::size;
+                    break;
+
+                case state::trailer:
+                    // Trailer fields are ignored; an empty line ends the body.
+                    if (c == '\r') {
+                        state_ = state::trailer_lf;
+                    } else if (++line_size_ > max_line_size) {
+                        return parse_result::invalid;
+                    }
+                    break;
+
+                case state::trailer_lf:
+                    if (c != '\n') {
+                        return parse_result::invalid;
+                    }
+
+                    if (line_size_ == 0) {
+                        state_ = state::done;
+                        return parse_result::completed;
+                    }
+
+                    line_size_ = 0;
+                    state_ = state::trailer;
+                    break;
+
+                case state::data:
+                case state::done:
+                    break;
+            }
+
+            if (state_ == state::done) {
+                break;
+            }
+        }
+
+        return state_ == state::done ? parse_result::completed : parse_result::in_progress;
+    }
+
+    std::string_view write_chunk_header(char (&buffer)[max_chunk_header_size], std::size_t size) noexcept {
+        auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer) - 2, size, 16);
+        *end++ = '\r';
+        *end++ = '\n';
+        return std::string_view{buffer, static_cast<std::size_t>(end - buffer)};
+    }
+
+    void write_chunk(std::pmr::string& out, std::span<const std::byte> data) {
+        if (data.empty()) {
+            return;
+        }
+
+        char header[max_chunk_header_size];
+        out += write_chunk_header(header, data.size());
+        out.append(reinterpret_cast<const char*>(data.data()), data.size());
+        out += "\r\n";
+    }
+
+    void write_last_chunk(std::pmr::string& out) {
+        out += last_chunk;
+    }
+} // namespace mio::http1
@@ -0,0 +1,98 @@
+#include "mio/http1/date.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mio::http1 {
+    namespace {
+        constexpr std::string_view day_names[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+        constexpr std::string_view month_names[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+        char* write_2digits(char* p, int value) noexcept {
+            *p++ = static_cast<char>('0' + value / 10);
+            *p++ = static_cast<char>('0' + value % 10);
+            return p;
+        }
+    } // namespace
+
+    std::array<char, date_size> format_date(std::time_t time) noexcept {
+        std::tm tm{};
+        ::gmtime_r(&time, &tm);
+
+        std::array<char, date_size> out{};
+        char* p = out.data();
+
+        p = std::copy_n(day_names[tm.tm_wday].data(), 3, p);
+        *p++ = ',';
+        *p++ = ' ';
+        p = write_2digits(p, tm.tm_mday);
+        *p++ = ' ';
+        p = std::copy_n(month_names[tm.tm_mon].data(), 3, p);
+        *p++ = ' ';
+        p = write_2digits(p, (tm.tm_year + 1900) / 100);
+        p = write_2digits(p, (tm.tm_year + 1900) % 100);
+        *p++ = ' ';
+        p = write_2digits(p, tm.tm_hour);
+        *p++ = ':';
+        p = write_2digits(p, tm.tm_min);
+        *p++ = ':';
+        p = write_2digits(p, tm.tm_sec);
+        std::copy_n(" GMT", 4, p);
+
+        return out;
+    }
+
+    date_header::date_header(std::time_t now) noexcept {
+        update(now);
+    }
+
+    void date_header::update(std::time_t now) noexcept {
+        // The sequence is still 0 before the first update.
+        if (now == time_ && sequence_.load(std::memory_order_relaxed) != 0) {
+            return;
+        }
+        time_ = now;
+
+        char text[word_count * sizeof(std::uint64_t)] = {};
+        const auto date = format_date(now);
+        std::copy(std::begin(prefix), std::end(prefix), text);
+        std::copy(std::begin(date), std::end(date), text + prefix.size());
+        std::copy_n("\r\n", 2, text + prefix.size() + date_size);
+
+        const auto sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (std::size_t i = 0; i < word_count; i++) {
+            std::uint64_t word;
+            std::memcpy(&word, text + i * sizeof(word), sizeof(word));
+            words_[i].store(word, std::memory_order_relaxed);
+        }
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    date_header::line date_header::get() const noexcept {
+        std::uint64_t words[word_count];
+
+        for (;;) {
+            const auto before = sequence_.load(std::memory_order_acquire);
+            if (before % 2 != 0) {
+                continue;
+            }
+
+            for (std::size_t i = 0; i < word_count; i++) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+
+        line out;
+        std::memcpy(out.data(), words, size);
+        return out;
+    }
+} // namespace mio::http1
@@ -144,7 +144,8 @@ namespace mio::http1 {
             CHECK_RESULT(expect_char('T', s, i));
             CHECK_RESULT(expect_char('P', s, i));
             CHECK_RESULT(expect_char('/', s, i));
-            CHECK_RESULT(expect_char('1', s, i));
+            // Any major version is accepted here so that the server can answer 505 rather than 400.
+            CHECK_RESULT(expect_n(is_digit, s, i));
             CHECK_RESULT(expect_char('.', s, i));
             CHECK_RESULT(expect_n(is_digit, s, i));
 
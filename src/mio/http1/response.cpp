@@ -1,5 +1,7 @@
 #include "mio/http1/response.hpp"
 
+#include <charconv>
+
 namespace mio::http1 {
     void write_response(std::ostream& ostream, const response& res) {
         ostream << res.http_version << " " << res.status_code << " " << status_code_string(res.status_code) << "\r\n";
@@ -8,8 +10,64 @@ namespace mio::http1 {
             ostream << header.key << ": " << header.value << "\r\n";
         }
 
+        if (res.chunked) {
+            ostream << "transfer-encoding: chunked\r\n\r\n";
+            return;
+        }
+
         ostream << "content-length: " << res.body.size() << "\r\n";
         ostream << "\r\n";
         ostream.write(reinterpret_cast<const char*>(res.body.data()), res.body.size());
     }
+
+    void write_response(std::pmr::string& out, const response& res) {
+        out.reserve(out.size() + res.body.size() + 256);
+
+        write_response_head(out, res);
+        if (!res.chunked) {
+            out.append(reinterpret_cast<const char*>(res.body.data()), res.body.size());
+        }
+    }
+
+    void write_response_head(std::pmr::string& out, const response& res) {
+        const auto append_int = [&](auto value) {
+            char buffer[24];
+            const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+            out.append(buffer, end);
+        };
+
+        std::size_t size = res.http_version.size() + status_code_string(res.status_code).size() + 64;
+        for (const auto& header : res.headers) {
+            size += header.key.size() + header.value.size() + 4;
+        }
+        out.reserve(out.size() + size);
+
+        if (const auto line = status_line(res.status_code); !line.empty() && res.http_version == "HTTP/1.1") {
+            out += line;
+        } else {
+            out += res.http_version;
+            out += ' ';
+            append_int(res.status_code);
+            out += ' ';
+            out += status_code_string(res.status_code);
+            out += "\r\n";
+        }
+
+        for (const auto& header : res.headers) {
+            out += header.key;
+            out += ": ";
+            out += header.value;
+            out += "\r\n";
+        }
+
+        if (res.chunked) {
+            out += "transfer-encoding: chunked\r\n\r\n";
+            return;
+        }
+
+        out += "content-length: ";
+        append_int(res.body.size());
+        out += "\r\n";
+        out += "\r\n";
+    }
 } // namespace mio::http1
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <charconv>
+#include <stdexcept>
 
 namespace mio {
     namespace {
@@ -10,27 +11,50 @@ namespace mio {
             return ('A' <= c && c <= 'Z') ? static_cast<unsigned char>(c) | 0x20 : c;
         }
 
-        std::string to_lower(std::string_view s) {
-            std::string t{};
+        std::pmr::string to_lower(std::string_view s, std::pmr::memory_resource* resource) {
+            std::pmr::string t{resource};
             t.reserve(s.size());
 
             std::ranges::copy(std::ranges::views::transform(s, to_ascii_lower), std::back_inserter(t));
             return t;
         }
 
+        // Calls f with the lower-cased key, avoiding allocation for keys of usual length.
+        template <typename F>
+        decltype(auto) with_lower_key(std::string_view key, std::pmr::memory_resource* resource, F f) {
+            constexpr std::size_t max_inline_key = 64;
+
+            if (key.size() <= max_inline_key) {
+                char buffer[max_inline_key];
+                std::ranges::copy(std::ranges::views::transform(key, to_ascii_lower), buffer);
+                return f(std::string_view{buffer, key.size()});
+            }
+
+            const auto key_lower = to_lower(key, resource);
+            return f(std::string_view{key_lower});
+        }
+
+        // The whole of `s` must be digits: a number followed by anything else would leave bytes of the body to be read
+        // as the next request.
         template <std::integral Int>
         std::optional<Int> parse_int(std::string_view s) noexcept {
             Int value;
-            if (const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value, 10); ec != std::errc{}) {
+            if (const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value, 10); ec != std::errc{} || ptr != s.data() + s.size()) {
                 return std::nullopt;
             }
             return value;
         }
     } // namespace
 
-    http_headers::http_headers(std::initializer_list<http_header> headers)
-        : entries_()
-        , indices_()
+    http_headers::http_headers(std::pmr::memory_resource* resource)
+        : entries_(resource)
+        , indices_(resource)
+        , content_length_(0) {
+    }
+
+    http_headers::http_headers(std::initializer_list<http_header> headers, std::pmr::memory_resource* resource)
+        : entries_(resource)
+        , indices_(resource)
         , content_length_(0) {
         for (const http_header& header : headers) {
             append(header.key, header.value);
@@ -38,9 +62,9 @@ namespace mio {
     }
 
     template <std::ranges::range Headers>
-    http_headers::http_headers(const Headers& headers)
-        : entries_()
-        , indices_()
+    http_headers::http_headers(const Headers& headers, std::pmr::memory_resource* resource)
+        : entries_(resource)
+        , indices_(resource)
         , content_length_(0) {
         for (const http_header& header : headers) {
             append(header.key, header.value);
@@ -48,16 +72,17 @@ namespace mio {
     }
 
     std::optional<std::string_view> http_headers::get(std::string_view key) const {
-        const auto key_lower = to_lower(key);
-        if (const auto it = indices_.find(key_lower); it != std::end(indices_)) {
-            return entries_[it->second].value;
-        }
+        return with_lower_key(key, resource(), [&](std::string_view key_lower) -> std::optional<std::string_view> {
+            if (const auto it = indices_.find(key_lower); it != std::end(indices_)) {
+                return entries_[it->second].value;
+            }
 
-        return std::nullopt;
+            return std::nullopt;
+        });
     }
 
     void http_headers::set(std::string_view key, std::string_view value) {
-        auto key_lower = to_lower(key);
+        auto key_lower = to_lower(key, resource());
         if (const auto it = indices_.find(key_lower); it != std::end(indices_)) {
             entries_[it->second].value = value;
         } else {
@@ -71,15 +96,21 @@ namespace mio {
             }
 
             indices_.emplace(key_lower, entries_.size());
-            entries_.emplace_back(http_header{std::move(key_lower), std::string{value}});
+            entries_.emplace_back(http_header{std::move(key_lower), std::pmr::string{value, resource()}});
         }
     }
 
     void http_headers::append(std::string_view key, std::string_view value) {
-        auto key_lower = to_lower(key);
+        if (!try_append(key, value)) {
+            throw std::runtime_error{"invalid request"};
+        }
+    }
+
+    request_result<void> http_headers::try_append(std::string_view key, std::string_view value) {
+        auto key_lower = to_lower(key, resource());
         if (const auto it = indices_.find(key_lower); it != std::end(indices_)) {
             if (key_lower == "content-length") {
-                throw std::runtime_error{"invalid request"};
+                return util::unexpected{request_error::bad_request};
             }
 
             auto& entry = entries_[it->second];
@@ -89,31 +120,34 @@ namespace mio {
             if (key_lower == "content-length") {
                 const auto content_length = parse_int<std::size_t>(value);
                 if (!content_length) {
-                    throw std::runtime_error{"invalid request"};
+                    return util::unexpected{request_error::bad_request};
                 }
 
                 content_length_ = *content_length;
             }
 
             indices_.emplace(key_lower, entries_.size());
-            entries_.emplace_back(http_header{std::move(key_lower), std::string{value}});
+            entries_.emplace_back(http_header{std::move(key_lower), std::pmr::string{value, resource()}});
         }
+
+        return {};
     }
 
     void http_headers::remove(std::string_view key) {
-        const auto key_lower = to_lower(key);
-        if (const auto it = indices_.find(key_lower); it != std::end(indices_)) {
-            const auto index = it->second;
-
-            indices_.erase(it);
-            entries_.erase(std::begin(entries_) + index);
-
-            // Shift indices.
-            for (auto& [key, i] : indices_) {
-                if (i > index) {
-                    i -= 1;
+        with_lower_key(key, resource(), [&](std::string_view key_lower) {
+            if (const auto it = indices_.find(key_lower); it != std::end(indices_)) {
+                const auto index = it->second;
+
+                indices_.erase(it);
+                entries_.erase(std::begin(entries_) + index);
+
+                // Shift indices.
+                for (auto& [key, i] : indices_) {
+                    if (i > index) {
+                        i -= 1;
+                    }
                 }
             }
-        }
+        });
     }
 } // namespace mio
@@ -1,147 +1,1275 @@
 #include "mio/http_server.hpp"
 
 #include <cassert>
-#include <sstream>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <optional>
+#include <system_error>
 #include <thread>
+#include <utility>
 
+#include <fcntl.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include "mio/application.hpp"
-#include "mio/bodies/x_www_form_url_encoded.hpp"
+#include "mio/http1/chunked.hpp"
 #include "mio/http1/request.hpp"
 #include "mio/http1/response.hpp"
+#include "mio/memory/arena.hpp"
+#include "mio/prebuilt_response.hpp"
+#include "mio/request_error.hpp"
+#include "mio/request_stage.hpp"
+#include "mio/sockets/output_buffer.hpp"
 #include "mio/sockets/socket.hpp"
-#include "mio/util/trim.hpp"
+#include "mio/util/temporary_file.hpp"
 
 namespace mio {
     namespace {
         constexpr std::size_t max_header_size = 4096;
         constexpr std::size_t max_header_lines = 100;
 
-        http1::response convert_to_http1_response(const http_response& from, std::span<http1::header> buffer) {
+        // Unread request bodies up to this size are skipped to keep the connection alive; it is closed otherwise.
+        constexpr std::size_t max_skipped_body_size = 64 * 1024;
+
+        constexpr std::chrono::milliseconds timer_resolution{100};
+
+        // Connections accepted from one listener per wakeup, so that a busy listener does not starve the others.
+        constexpr std::size_t max_accept_batch = 64;
+
+        constexpr std::string_view continue_response = "HTTP/1.1 100 Continue\r\n\r\n";
+
+        // Thrown when reading the request is cut off by its deadline.
+        class request_timeout : public std::runtime_error {
+        public:
+            request_timeout()
+                : std::runtime_error{"request timeout"} {
+            }
+        };
+
+        // Writes all of `bytes` to a file.
+        void write_all(int fd, std::span<const std::byte> bytes) {
+            while (!bytes.empty()) {
+                const auto n = ::write(fd, bytes.data(), bytes.size());
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::system_error{errno, std::generic_category()};
+                }
+
+                bytes = bytes.subspan(static_cast<std::size_t>(n));
+            }
+        }
+
+        // The deadline of whatever the connection is waiting for. When it passes, the timer thread shuts the socket
+        // down, which wakes the connection thread from its blocking call.
+        //
+        // Arming and disarming only store the deadline, without taking the lock of the timer wheel. The connection's
+        // timer is scheduled once, and checks the deadline when it fires: it moves itself to the deadline if that is
+        // still ahead, and at most one shortest timeout later, since no deadline armed in between can come sooner.
+        class connection_deadline {
+        public:
+            enum class phase {
+                idle,   // Waiting for the next request on a kept-alive connection.
+                header, // Receiving the request headers, as a whole.
+                body,   // Receiving one piece of the request body.
+                write,  // Sending the response.
+            };
+
+            connection_deadline(util::timer_wheel& wheel, std::mutex& mutex, const http_server_options& options, sockets::socket& socket)
+                : wheel_(wheel)
+                , mutex_(mutex)
+                , options_(options)
+                , socket_(socket)
+                , timer_([this] { on_timer(); }) {
+                for (const auto p : {phase::idle, phase::header, phase::body, phase::write}) {
+                    if (const auto t = timeout(p); t > std::chrono::milliseconds::zero()) {
+                        check_interval_ = check_interval_ > std::chrono::milliseconds::zero() ? std::min(check_interval_, t) : t;
+                    }
+                }
+
+                if (check_interval_ > std::chrono::milliseconds::zero()) {
+                    const std::lock_guard lock{mutex_};
+                    wheel_.schedule(timer_, util::timer_wheel::clock::now() + check_interval_);
+                }
+            }
+
+            ~connection_deadline() noexcept {
+                const std::lock_guard lock{mutex_};
+                wheel_.cancel(timer_);
+            }
+
+            // Uncopyable and unmovable
+            connection_deadline(const connection_deadline&) = delete;
+            connection_deadline(connection_deadline&&) = delete;
+
+            connection_deadline& operator=(const connection_deadline&) = delete;
+            connection_deadline& operator=(connection_deadline&&) = delete;
+
+            void arm(phase p) noexcept {
+                const auto timeout = this->timeout(p);
+                if (timeout <= std::chrono::milliseconds::zero()) {
+                    disarm();
+                    return;
+                }
+
+                deadline_.store(encode(util::timer_wheel::clock::now() + timeout, p), std::memory_order_relaxed);
+            }
+
+            void disarm() noexcept {
+                deadline_.store(0, std::memory_order_relaxed);
+            }
+
+            // Arms `p` in place of the current deadline, which is returned to be restored afterwards.
+            [[nodiscard]] std::int64_t interrupt(phase p) noexcept {
+                const auto interrupted = deadline_.load(std::memory_order_relaxed);
+                arm(p);
+                return interrupted;
+            }
+
+            void restore(std::int64_t interrupted) noexcept {
+                deadline_.store(interrupted, std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] bool expired() const noexcept {
+                return expired_.load(std::memory_order_acquire);
+            }
+
+        private:
+            using deadline_duration = std::chrono::milliseconds;
+
+            // A deadline in milliseconds on the steady clock with its phase in the low bits, or 0 when disarmed.
+            [[nodiscard]] static std::int64_t encode(util::timer_wheel::clock::time_point deadline, phase p) noexcept {
+                const auto ms = std::chrono::ceil<deadline_duration>(deadline.time_since_epoch()).count();
+                return (ms << 2) | static_cast<std::int64_t>(p);
+            }
+
+            [[nodiscard]] static util::timer_wheel::clock::time_point decode_deadline(std::int64_t encoded) noexcept {
+                return util::timer_wheel::clock::time_point{deadline_duration{encoded >> 2}};
+            }
+
+            [[nodiscard]] static phase decode_phase(std::int64_t encoded) noexcept {
+                return static_cast<phase>(encoded & 3);
+            }
+
+            [[nodiscard]] std::chrono::milliseconds timeout(phase p) const noexcept {
+                switch (p) {
+                    case phase::idle:
+                        return options_.idle_timeout;
+                    case phase::header:
+                        return options_.header_timeout;
+                    case phase::body:
+                        return options_.body_timeout;
+                    case phase::write:
+                        return options_.write_timeout;
+                }
+                return std::chrono::milliseconds::zero();
+            }
+
+            // Runs on the timer thread with the mutex held.
+            void on_timer() noexcept {
+                const auto now = util::timer_wheel::clock::now();
+                const auto next_check = now + check_interval_;
+
+                auto encoded = deadline_.load(std::memory_order_relaxed);
+                if (encoded == 0) {
+                    wheel_.schedule(timer_, next_check);
+                    return;
+                }
+
+                if (const auto deadline = decode_deadline(encoded); deadline > now) {
+                    wheel_.schedule(timer_, std::min(deadline, next_check));
+                    return;
+                }
+
+                // Unless the connection has moved on to another deadline meanwhile.
+                if (!deadline_.compare_exchange_strong(encoded, 0, std::memory_order_relaxed)) {
+                    wheel_.schedule(timer_, next_check);
+                    return;
+                }
+
+                expired_.store(true, std::memory_order_release);
+
+                // Only a blocked send needs the write side shut; otherwise it stays open for the 408.
+                socket_.shutdown(decode_phase(encoded) == phase::write ? sockets::shutdown_type::both : sockets::shutdown_type::receive);
+            }
+
+        private:
+            util::timer_wheel& wheel_;
+            std::mutex& mutex_;
+            const http_server_options& options_;
+            sockets::socket& socket_;
+            util::timer_wheel::timer timer_;
+            std::chrono::milliseconds check_interval_ = std::chrono::milliseconds::zero(); // The shortest timeout.
+            std::atomic<std::int64_t> deadline_ = 0;
+            std::atomic<bool> expired_ = false;
+        };
+
+        // The socket of a client with what was received but not consumed yet and what is waiting to be sent.
+        // Unconsumed input outlives a request, so a pipelined request that arrived along with the previous one is
+        // parsed without another receive, and its response is queued behind the previous one.
+        class connection {
+        public:
+            connection(sockets::socket& socket, connection_deadline& deadline)
+                : socket(socket)
+                , deadline(deadline)
+                , output(socket) {
+            }
+
+            // Uncopyable and unmovable
+            connection(const connection&) = delete;
+            connection(connection&&) = delete;
+
+            connection& operator=(const connection&) = delete;
+            connection& operator=(connection&&) = delete;
+
+            [[nodiscard]] std::span<std::byte> buffered() noexcept {
+                return std::span{input_}.subspan(begin_, end_ - begin_);
+            }
+
+            [[nodiscard]] std::string_view buffered_text() const noexcept {
+                return std::string_view{reinterpret_cast<const char*>(input_ + begin_), end_ - begin_};
+            }
+
+            [[nodiscard]] bool is_input_full() const noexcept {
+                return begin_ == 0 && end_ == sizeof(input_);
+            }
+
+            void consume(std::size_t n) noexcept {
+                assert(n <= end_ - begin_);
+                begin_ += n;
+                if (begin_ == end_) {
+                    begin_ = end_ = 0;
+                }
+            }
+
+            // Receives more input after the buffered bytes. Returns 0 if the connection is closed.
+            std::size_t receive() {
+                if (begin_ > 0) {
+                    std::memmove(input_, input_ + begin_, end_ - begin_);
+                    end_ -= begin_;
+                    begin_ = 0;
+                }
+
+                const auto n = receive(input_ + end_, sizeof(input_) - end_);
+                end_ += n;
+                return n;
+            }
+
+            // Waits for bytes from the socket.
+            std::size_t receive(std::byte* data, std::size_t size) {
+                flush_before_receive();
+
+                const auto n = socket.receive(data, size);
+                bytes_received += n;
+                return n;
+            }
+
+            // Moves up to `size` bytes from the socket to the file `fd` through a pipe, so that they never enter user
+            // space. Returns 0 if the connection is closed.
+            std::size_t splice(int fd, std::size_t size) {
+                flush_before_receive();
+
+                if (!pipe_read_) {
+                    int fds[2];
+                    if (::pipe2(fds, O_CLOEXEC) < 0) {
+                        throw std::system_error{errno, std::generic_category()};
+                    }
+
+                    pipe_read_.reset(fds[0]);
+                    pipe_write_.reset(fds[1]);
+                }
+
+                for (;;) {
+                    // The pipe is always empty here, so EAGAIN means the socket has nothing yet.
+                    const auto n = ::splice(socket.descriptor(), nullptr, pipe_write_.get(), nullptr, size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                    if (n > 0) {
+                        drain_pipe(fd, static_cast<std::size_t>(n));
+                        bytes_received += static_cast<std::size_t>(n);
+                        return static_cast<std::size_t>(n);
+                    }
+
+                    if (n == 0) {
+                        return 0;
+                    }
+
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        socket.wait_readable();
+                    } else if (errno != EINTR) {
+                        throw std::system_error{errno, std::generic_category()};
+                    }
+                }
+            }
+
+            // A send may interrupt a receive, whose deadline resumes afterwards.
+            void flush() {
+                const auto interrupted = deadline.interrupt(connection_deadline::phase::write);
+                output.flush();
+                deadline.restore(interrupted);
+            }
+
+            // Waits until the kernel is done with the pages of zero-copy sends, so that the response body can be freed.
+            void release_zero_copy() {
+                if (output.reap_zero_copy()) {
+                    return;
+                }
+
+                const auto interrupted = deadline.interrupt(connection_deadline::phase::write);
+                while (!output.reap_zero_copy()) {
+                    if (deadline.expired()) {
+                        throw_closed();
+                    }
+                    socket.wait_error_queue();
+                }
+                deadline.restore(interrupted);
+            }
+
+            [[noreturn]] void throw_closed() const {
+                if (deadline.expired()) {
+                    throw request_timeout{};
+                }
+                throw std::runtime_error{"connection closed"};
+            }
+
+        public:
+            sockets::socket& socket;
+            connection_deadline& deadline;
+            sockets::output_buffer output;
+
+            // `100 Continue` is owed before the body is first received from the socket.
+            bool continue_pending = false;
+
+            // Everything received so far, including what was spliced to a file.
+            std::uint64_t bytes_received = 0;
+
+        private:
+            // What is queued for output goes out before waiting for input, since the client may be waiting for it
+            // before it sends more.
+            void flush_before_receive() {
+                if (std::exchange(continue_pending, false)) {
+                    output.write(continue_response);
+                }
+
+                if (!output.empty()) {
+                    flush();
+                }
+            }
+
+            void drain_pipe(int fd, std::size_t size) {
+                while (size > 0) {
+                    const auto n = ::splice(pipe_read_.get(), nullptr, fd, nullptr, size, SPLICE_F_MOVE);
+                    if (n > 0) {
+                        size -= static_cast<std::size_t>(n);
+                    } else if (n < 0 && errno == EINTR) {
+                        continue;
+                    } else {
+                        // What is left in the pipe would end up in the next file.
+                        const auto error = n < 0 ? errno : EIO;
+                        pipe_read_.reset();
+                        pipe_write_.reset();
+                        throw std::system_error{error, std::generic_category()};
+                    }
+                }
+            }
+
+        private:
+            std::byte input_[max_header_size];
+            std::size_t begin_ = 0;
+            std::size_t end_ = 0;
+
+            // Created on the first splice and kept for the connection.
+            util::unique_fd pipe_read_{};
+            util::unique_fd pipe_write_{};
+        };
+
+        // Reads the request body off the connection.
+        class request_body_reader : public body_reader {
+        public:
+            // Discards the rest of the body if it is at most max_size bytes. Returns true if the body is consumed.
+            virtual bool skip(std::size_t max_size) = 0;
+        };
+
+        // Reads a Content-Length delimited body: first the bytes received along with the headers, then the socket.
+        // It never receives past the body, so what follows stays on the connection for the next request.
+        class content_length_reader final : public request_body_reader {
+        public:
+            content_length_reader(connection& conn, std::size_t content_length) noexcept
+                : conn_(conn)
+                , remaining_(content_length) {
+            }
+
+            std::size_t read_some(std::span<std::byte> buffer) override {
+                const auto n = receive(buffer);
+                if (n == 0 && remaining_ > 0) {
+                    conn_.throw_closed();
+                }
+                return n;
+            }
+
+            // Returns 0 at the end of the body or if the connection is closed.
+            std::size_t receive(std::span<std::byte> buffer) {
+                const auto size = std::min(buffer.size(), remaining_);
+                if (size == 0) {
+                    return 0;
+                }
+
+                std::size_t n;
+                if (const auto buffered = conn_.buffered(); !buffered.empty()) {
+                    n = std::min(size, buffered.size());
+                    std::copy_n(buffered.data(), n, buffer.data());
+                    conn_.consume(n);
+                } else {
+                    conn_.deadline.arm(connection_deadline::phase::body);
+                    n = conn_.receive(buffer.data(), size);
+                    conn_.deadline.disarm();
+                }
+
+                remaining_ -= n;
+                return n;
+            }
+
+            // Moves the rest of the body into the file `fd`: what was received with the headers is written, the rest
+            // is spliced from the socket. Returns the bytes moved.
+            std::size_t splice_to(int fd) {
+                std::size_t total = 0;
+
+                if (const auto buffered = conn_.buffered().first(std::min(conn_.buffered().size(), remaining_)); !buffered.empty()) {
+                    write_all(fd, buffered);
+                    conn_.consume(buffered.size());
+
+                    remaining_ -= buffered.size();
+                    total += buffered.size();
+                }
+
+                while (remaining_ > 0) {
+                    conn_.deadline.arm(connection_deadline::phase::body);
+                    const auto n = conn_.splice(fd, remaining_);
+                    conn_.deadline.disarm();
+
+                    if (n == 0) {
+                        conn_.throw_closed();
+                    }
+
+                    remaining_ -= n;
+                    total += n;
+                }
+
+                return total;
+            }
+
+            bool skip(std::size_t max_size) override {
+                // The client is still waiting for 100 Continue and may or may not send the body anyway.
+                if (remaining_ > max_size || (conn_.continue_pending && remaining_ > conn_.buffered().size())) {
+                    return false;
+                }
+
+                std::byte scratch[4096];
+                while (receive(scratch) != 0) {
+                }
+
+                return remaining_ == 0;
+            }
+
+        private:
+            connection& conn_;
+            std::size_t remaining_;
+        };
+
+        // Reads a body with the chunked transfer coding. The input is decoded in place in the connection buffer, so
+        // bytes past the last chunk stay there for the next request.
+        class chunked_reader final : public request_body_reader {
+        public:
+            chunked_reader(connection& conn, std::size_t max_size) noexcept
+                : conn_(conn)
+                , max_size_(max_size) {
+            }
+
+            std::size_t read_some(std::span<std::byte> buffer) override {
+                while (!decoder_.done() && !buffer.empty()) {
+                    if (conn_.buffered().empty()) {
+                        conn_.deadline.arm(connection_deadline::phase::body);
+                        const auto n = conn_.receive();
+                        conn_.deadline.disarm();
+
+                        if (n == 0) {
+                            conn_.throw_closed();
+                        }
+                    }
+
+                    // Decode no more than fits in `buffer`: the decoded bytes replace the input they came from.
+                    const auto input = conn_.buffered().first(std::min(conn_.buffered().size(), buffer.size()));
+
+                    std::size_t size;
+                    std::size_t consumed;
+                    if (decoder_.decode(input, size, consumed) == http1::parse_result::invalid) {
+                        throw request_error_exception{request_error::bad_request};
+                    }
+
+                    // A Content-Length is checked before reading instead.
+                    if (size > max_size_ - size_) {
+                        throw request_error_exception{request_error::payload_too_large};
+                    }
+
+                    std::copy_n(input.data(), size, buffer.data());
+                    conn_.consume(consumed);
+
+                    if (size > 0) {
+                        size_ += size;
+                        return size;
+                    }
+                }
+
+                return 0;
+            }
+
+            bool skip(std::size_t max_size) override {
+                if (conn_.continue_pending && !decoder_.done()) {
+                    return false;
+                }
+
+                std::byte scratch[4096];
+                for (std::size_t skipped = 0; skipped <= max_size;) {
+                    std::size_t n;
+                    try {
+                        n = read_some(scratch);
+                    } catch (const std::runtime_error&) {
+                        return false; // Malformed, too large, timed out or closed: the connection is done either way.
+                    }
+
+                    if (n == 0) {
+                        return true;
+                    }
+
+                    skipped += n;
+                }
+
+                return false;
+            }
+
+        private:
+            connection& conn_;
+            http1::chunked_decoder decoder_{};
+            std::size_t max_size_;
+            std::size_t size_ = 0;
+        };
+
+        // Queues each piece of a streamed response body as one chunk. Past the high-water mark the writer blocks
+        // until the queue is sent, so a handler cannot produce faster than the client reads.
+        class chunked_writer final : public body_writer {
+        public:
+            chunked_writer(connection& conn, std::size_t high_water_mark) noexcept
+                : conn_(conn)
+                , high_water_mark_(high_water_mark) {
+            }
+
+            void write(std::span<const std::byte> bytes) override {
+                if (bytes.empty()) {
+                    return;
+                }
+
+                char header[http1::max_chunk_header_size];
+                conn_.output.write(http1::write_chunk_header(header, bytes.size()));
+                conn_.output.write(bytes);
+                conn_.output.write("\r\n");
+
+                if (conn_.output.size() >= high_water_mark_) {
+                    conn_.flush();
+                }
+            }
+
+            void flush() override {
+                conn_.flush();
+            }
+
+            void finish() {
+                conn_.output.write(http1::last_chunk);
+            }
+
+        private:
+            connection& conn_;
+            std::size_t high_water_mark_;
+        };
+
+        // Collects a streamed response body for clients that do not understand the chunked transfer coding.
+        class buffering_writer final : public body_writer {
+        public:
+            explicit buffering_writer(http_response& res) noexcept
+                : res_(res) {
+            }
+
+            void write(std::span<const std::byte> bytes) override {
+                res_.write(bytes);
+            }
+
+        private:
+            http_response& res_;
+        };
+
+        // Compares `s` case-insensitively with the lowercase string `lower`.
+        bool equals_lowercase(std::string_view s, std::string_view lower) noexcept {
+            return std::equal(std::begin(s), std::end(s), std::begin(lower), std::end(lower), [](char a, char b) {
+                return static_cast<char>(std::tolower(static_cast<unsigned char>(a))) == b;
+            });
+        }
+
+        // Returns true if the last transfer coding is chunked. Other codings are not supported.
+        bool is_chunked(std::string_view transfer_encoding) noexcept {
+            const auto pos = transfer_encoding.find_last_of(',');
+            auto coding = pos == std::string_view::npos ? transfer_encoding : transfer_encoding.substr(pos + 1);
+
+            while (!coding.empty() && (coding.front() == ' ' || coding.front() == '\t')) {
+                coding.remove_prefix(1);
+            }
+            while (!coding.empty() && (coding.back() == ' ' || coding.back() == '\t')) {
+                coding.remove_suffix(1);
+            }
+
+            return equals_lowercase(coding, "chunked");
+        }
+
+        sockets::socket open_listener(const sockets::endpoint& endpoint, const listen_options& options) {
+            const auto family = endpoint.family();
+
+            sockets::socket socket{family, sockets::socket_type::stream};
+
+            if (family == sockets::address_family::local) {
+                // A socket file left behind by a previous run would make bind() fail.
+                if (const auto path = endpoint.path(); !path.empty() && path.front() != '@') {
+                    if (struct ::stat st {}; ::stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+                        ::unlink(path.c_str());
+                    }
+                }
+
+                socket.listen(endpoint, options.backlog);
+                socket.set_non_blocking(true);
+                return socket;
+            }
+
+            socket.set_reuse_addr(options.reuse_addr);
+
+            if (family == sockets::address_family::inet6) {
+                socket.set_v6_only(false);
+            }
+
+            // Options the accepted sockets inherit, or that only apply to a listening socket.
+            // Failures are ignored: they only lose an optimization (e.g. fast open disabled by the kernel).
+            if (options.keep_alive) {
+                socket.set_keep_alive(true);
+            }
+            if (options.send_buffer_size > 0) {
+                socket.set_send_buffer_size(options.send_buffer_size);
+            }
+            if (options.receive_buffer_size > 0) {
+                socket.set_receive_buffer_size(options.receive_buffer_size);
+            }
+            if (options.defer_accept > 0) {
+                socket.set_defer_accept(options.defer_accept);
+            }
+            if (options.fast_open > 0) {
+                socket.set_fast_open(options.fast_open);
+            }
+
+            socket.listen(endpoint, options.backlog);
+            socket.set_non_blocking(true);
+            return socket;
+        }
+
+        sockets::socket open_listener(const listener& l) {
+            try {
+                return open_listener(l.endpoint, l.options);
+            } catch (const std::system_error& e) {
+                // Without IPv6, the socket cannot be created or the wildcard cannot be bound; IPv4 is then all there is.
+                const bool no_ipv6 = e.code() == std::errc::address_family_not_supported || e.code() == std::errc::address_not_available;
+                if (!no_ipv6 || l.endpoint.family() != sockets::address_family::inet6 || !l.endpoint.is_any()) {
+                    throw;
+                }
+                return open_listener(sockets::endpoint::any_v4(l.endpoint.port()), l.options);
+            }
+        }
+
+        // `date` is added as the Date header unless the response has one. `connection` replaces any Connection
+        // header of the response, which is left untouched since it may outlive the request.
+        http1::response convert_to_http1_response(const http_response& from, std::span<http1::header> buffer, std::string_view date, std::string_view connection) {
             http1::response res{};
             res.http_version = "HTTP/1.1";
             res.status_code = from.status_code();
 
             size_t n = 0;
-            for (const auto& header_entries = from.headers().entries(); n < header_entries.size() && n < buffer.size(); n++) {
-                buffer[n].key = header_entries[n].key;
-                buffer[n].value = header_entries[n].value;
+            for (const auto& header : from.headers().entries()) {
+                if (n == buffer.size()) {
+                    break;
+                }
+                if (header.key == "connection") {
+                    continue;
+                }
+
+                buffer[n].key = header.key;
+                buffer[n].value = header.value;
+                n++;
+            }
+
+            if (n < buffer.size()) {
+                buffer[n].key = "connection";
+                buffer[n].value = connection;
+                n++;
+            }
+
+            if (n < buffer.size() && !from.headers().get("date")) {
+                buffer[n].key = "date";
+                buffer[n].value = date;
+                n++;
             }
 
             res.headers = buffer.subspan(0, n);
             res.body = from.body();
+            res.chunked = from.is_streamed();
             return res;
         }
+
+        // Counts a connection as active while it is served, and records its requests along with the bytes it moved.
+        // Does nothing without metrics.
+        class connection_metrics {
+        public:
+            using clock = std::chrono::steady_clock;
+
+            connection_metrics(metrics* m, const connection& conn) noexcept
+                : metrics_(m)
+                , conn_(conn) {
+                if (metrics_) {
+                    metrics_->connection_opened();
+                    recorder_.emplace(*metrics_);
+                }
+            }
+
+            ~connection_metrics() noexcept {
+                if (metrics_) {
+                    record_bytes();
+                    recorder_.reset();
+                    metrics_->connection_closed();
+                }
+            }
+
+            // Uncopyable and unmovable
+            connection_metrics(const connection_metrics&) = delete;
+            connection_metrics(connection_metrics&&) = delete;
+
+            connection_metrics& operator=(const connection_metrics&) = delete;
+            connection_metrics& operator=(connection_metrics&&) = delete;
+
+            [[nodiscard]] bool enabled() const noexcept {
+                return metrics_ != nullptr;
+            }
+
+            // Marks the start of a request whose first bytes have just been received. A pipelined request, buffered
+            // already, starts when the previous response is done.
+            void start() noexcept {
+                if (metrics_) {
+                    start_ = clock::now();
+                }
+            }
+
+            void record_request(const route* route, std::size_t method, std::int32_t status, std::optional<request_error> error) noexcept {
+                if (!metrics_) {
+                    return;
+                }
+
+                const auto end = clock::now();
+                recorder_->record_request(route, method, status, end - start_);
+                if (error) {
+                    recorder_->record_request_error(*error);
+                }
+                record_bytes();
+
+                start_ = end;
+            }
+
+        private:
+            void record_bytes() noexcept {
+                const auto received = conn_.bytes_received;
+                const auto sent = conn_.output.bytes_sent();
+
+                recorder_->record_bytes(received - received_, sent - sent_);
+                received_ = received;
+                sent_ = sent;
+            }
+
+        private:
+            metrics* metrics_;
+            const connection& conn_;
+            std::optional<metrics::recorder> recorder_{};
+            clock::time_point start_{};
+            std::uint64_t received_ = 0;
+            std::uint64_t sent_ = 0;
+        };
     } // namespace
 
-    http_server::http_server(std::unique_ptr<application>&& app)
-        : app_(std::move(app)) {
+    http_server::http_server(std::unique_ptr<application>&& app, const http_server_options& options)
+        : app_(std::move(app))
+        , options_(options)
+        , timers_(timer_resolution, util::timer_wheel::clock::now())
+        , metrics_(options.metrics_path ? std::make_unique<metrics>() : nullptr) {
         assert(app_);
     }
 
     http_server::~http_server() noexcept = default;
 
-    void http_server::listen(std::uint16_t port) {
-        sockets::socket socket{sockets::address_family::inet, sockets::socket_type::stream};
-        socket.set_reuse_addr(true);
-        socket.listen(port);
+    void http_server::listen(std::uint16_t port, const listen_options& options) {
+        listen(sockets::endpoint::any(port), options);
+    }
+
+    void http_server::listen(const sockets::endpoint& endpoint, const listen_options& options) {
+        const listener l{endpoint, options};
+        listen(std::span{&l, 1});
+    }
+
+    void http_server::listen(std::span<const listener> listeners) {
+        std::vector<sockets::socket> sockets{};
+        std::vector<::pollfd> fds{};
+
+        for (const auto& l : listeners) {
+            const auto& socket = sockets.emplace_back(open_listener(l));
+            fds.push_back(::pollfd{.fd = socket.descriptor(), .events = POLLIN, .revents = 0});
+        }
+
+        // Kept open so that a descriptor can be freed to turn away connections when the process runs out of them.
+        util::unique_fd reserve_fd{::open("/dev/null", O_RDONLY | O_CLOEXEC)};
+
+        start_timers();
 
         for (;;) {
-            std::thread{&http_server::on_client_accepted, this, socket.accept()}.detach();
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error{errno, std::generic_category()};
+            }
+
+            for (std::size_t i = 0; i < fds.size(); i++) {
+                if (fds[i].revents & POLLIN) {
+                    accept_batch(listeners[i], sockets[i], reserve_fd);
+                }
+            }
         }
     }
 
-    void http_server::on_client_accepted(http_server* self, sockets::socket client_socket) noexcept {
+    void http_server::start_timers() {
+        std::call_once(timers_started_, [this] {
+            timer_thread_ = std::jthread{[this](std::stop_token stop) {
+                while (!stop.stop_requested()) {
+                    std::this_thread::sleep_for(timer_resolution);
+
+                    date_.update(std::time(nullptr));
+
+                    const std::lock_guard lock{timers_mutex_};
+                    timers_.advance(util::timer_wheel::clock::now());
+                }
+            }};
+        });
+    }
+
+    http_response http_server::metrics_response() const {
+        std::string text{};
+        metrics_->write_prometheus(text);
+
+        return http_response{
+            200,
+            http_headers{
+                {"content-type", "text/plain; version=0.0.4; charset=utf-8"},
+            },
+            text,
+        };
+    }
+
+    void http_server::accept_batch(const listener& l, sockets::socket& socket, util::unique_fd& reserve_fd) {
+        for (std::size_t n = 0; n < max_accept_batch; n++) {
+            sockets::endpoint peer{};
+            std::optional<sockets::socket> client_socket{};
+
+            try {
+                client_socket = socket.accept(peer);
+            } catch (const std::system_error& e) {
+                const auto error = e.code().value();
+                if (error == ENOBUFS || error == ENOMEM) {
+                    return; // Retried on the next wakeup.
+                }
+                if (error != EMFILE && error != ENFILE) {
+                    throw;
+                }
+
+                // Out of descriptors: accept with the reserve and close right away, so the client is refused
+                // instead of left hanging in the backlog and the listener stops reporting readiness.
+                reserve_fd.reset();
+                try {
+                    if (sockets::endpoint ignored{}; auto refused = socket.accept(ignored)) {
+                        refused->shutdown(sockets::shutdown_type::both);
+                    }
+                } catch (const std::system_error&) {
+                }
+                reserve_fd.reset(::open("/dev/null", O_RDONLY | O_CLOEXEC));
+                return;
+            }
+
+            if (!client_socket) {
+                return; // Drained.
+            }
+
+            std::thread{&http_server::serve_connection, this, &l.options, std::move(*client_socket), peer}.detach();
+        }
+    }
+
+    void http_server::serve(sockets::socket client_socket, const sockets::endpoint& peer, const listen_options& options) noexcept {
+        start_timers();
+        serve_connection(this, &options, std::move(client_socket), peer);
+    }
+
+    void http_server::serve_connection(http_server* self, const listen_options* options, sockets::socket client_socket, sockets::endpoint peer) noexcept {
         const auto& app = self->app_;
 
-        bool keep_alive;
+        // A socket pair has no peer address, and is served like a Unix domain socket.
+        const bool tcp = peer.family() == sockets::address_family::inet || peer.family() == sockets::address_family::inet6;
+        if (tcp && options->no_delay) {
+            client_socket.set_no_delay(true);
+        }
+
+        // Everything a request allocates comes from this arena, which is recycled between keep-alive requests.
+        memory::arena arena{};
+        const memory::resource_scope scope{arena.resource()};
+
+        connection_deadline deadline{self->timers_, self->timers_mutex_, self->options_, client_socket};
+        connection conn{client_socket, deadline};
+
+        if (tcp && options->zero_copy_threshold > 0) {
+            conn.output.enable_zero_copy(options->zero_copy_threshold);
+        }
+
+        connection_metrics stats{self->metrics_.get(), conn};
+
+        // However the connection ends, the thread is idle afterwards.
+        const request_stage_scope stage_scope{};
+
+        bool keep_alive = false;
         do {
-            char buffer[max_header_size];
+            enter_request_stage(request_stage::idle);
+
+            // Objects allocated from the arena must die before it is reset.
+            arena.reset();
+
             http1::header headers[max_header_lines];
             http_response res{500};
+            std::optional<content_length_reader> content_length_body{};
+            std::optional<chunked_reader> chunked_body{};
+            request_body_reader* reader = nullptr;
+            util::unique_fd body_file{};
+            bool accepts_chunked = false;
+
+            // Malformed requests are refused without throwing, so that junk traffic stays cheap.
+            std::optional<request_error> refused{};
+
+            // For the metrics, which outlive the request.
+            const route* matched_route = nullptr;
+            std::size_t method = metrics::method_index("OTHER"); // Until the request line is parsed.
+
+            // A request partly pipelined behind the previous one has started already.
+            deadline.arm(keep_alive && conn.buffered().empty() ? connection_deadline::phase::idle : connection_deadline::phase::header);
+            keep_alive = false;
 
             try {
-                std::size_t pos = 0;
+                enter_request_stage(request_stage::parse);
+
                 std::size_t header_size;
                 http1::request http1_req{};
 
-                // TODO: too large request header
+                // A pipelined request may be buffered already.
                 for (;;) {
-                    const auto size_read = client_socket.receive(buffer + pos, max_header_size - pos);
-                    if (size_read == 0) {
-                        return; // Connection closed.
+                    if (!conn.buffered().empty()) {
+                        const auto parse_result = http1::parse_request(http1_req, headers, conn.buffered_text(), header_size);
+                        if (parse_result == http1::parse_result::completed) {
+                            break;
+                        } else if (parse_result == http1::parse_result::too_many_headers) {
+                            refused = request_error::header_fields_too_large;
+                            break;
+                        } else if (parse_result != http1::parse_result::in_progress) {
+                            refused = request_error::bad_request;
+                            break;
+                        }
                     }
 
-                    pos += size_read;
-
-                    const auto parse_result = http1::parse_request(http1_req, headers, std::string_view{buffer, pos}, header_size);
-                    if (parse_result == http1::parse_result::completed) {
+                    if (conn.is_input_full()) {
+                        refused = request_error::header_fields_too_large;
                         break;
-                    } else if (parse_result == http1::parse_result::in_progress) {
-                        continue;
-                    } else {
-                        throw std::runtime_error{"invalid request"};
                     }
-                }
 
-                http_headers headers{};
-                for (const auto& header : http1_req.headers) {
-                    headers.append(header.key, header.value);
-                }
-
-                std::vector<std::byte> body(reinterpret_cast<const std::byte*>(buffer + header_size), reinterpret_cast<const std::byte*>(buffer + pos));
-                body.resize(headers.content_length());
+                    const bool started = !conn.buffered().empty();
 
-                for (pos -= header_size; pos < headers.content_length();) {
-                    const auto size_read = client_socket.receive(body.data() + pos, headers.content_length() - pos);
+                    const auto size_read = conn.receive();
                     if (size_read == 0) {
-                        return; // Connection closed.
+                        if (deadline.expired() && started) {
+                            throw request_timeout{};
+                        }
+                        return; // Connection closed, or idle for too long.
                     }
 
-                    pos += size_read;
+                    if (!started) {
+                        deadline.arm(connection_deadline::phase::header); // The request has started.
+                        stats.start();
+                    }
                 }
 
-                http_request req{
-                    http1_req.method,
-                    http1_req.request_uri,
-                    http1_req.http_version,
-                    std::move(headers),
-                    std::move(body),
-                };
+                deadline.disarm();
+
+                enter_request_stage(request_stage::headers);
+
+                if (refused) {
+                    res = app->on_request_error(*refused);
+                } else {
+                    http_headers headers{arena.resource()};
+                    for (const auto& header : http1_req.headers) {
+                        if (!headers.try_append(header.key, header.value)) {
+                            refused = request_error::bad_request;
+                        }
+                    }
 
-                keep_alive = req.headers().get("connection") == "keep-alive";
-                req.headers().remove("connection");
-                req.headers().remove("keep-alive");
+                    http_request req{
+                        http1_req.method,
+                        http1_req.request_uri,
+                        http1_req.http_version,
+                        std::move(headers),
+                        {},
+                        arena.resource(),
+                    };
 
-                if (const auto content_type = req.headers().get("content-type")) {
-                    const auto type = util::trim(content_type->substr(0, content_type->find(';')));
+                    req.set_peer(peer);
 
-                    if (type == "application/x-www-form-urlencoded") {
-                        bodies::parse_x_www_form_url_encoded(req);
+                    if (stats.enabled()) {
+                        method = metrics::method_index(req.method());
+                    }
+
+                    // The request has copied what it needs from the connection buffer.
+                    conn.consume(header_size);
+
+                    keep_alive = req.headers().get("connection") == "keep-alive";
+                    req.headers().remove("connection");
+                    req.headers().remove("keep-alive");
+
+                    const auto transfer_encoding = req.headers().get("transfer-encoding");
+                    if (transfer_encoding && (!is_chunked(*transfer_encoding) || req.headers().get("content-length"))) {
+                        // A message carrying both framings is rejected rather than guessing which one the peer meant.
+                        refused = request_error::bad_request;
+                    } else if (!req.http_version().starts_with("HTTP/1.")) {
+                        refused = request_error::http_version_not_supported;
                     }
-                }
 
-                res = app->on_request(req);
+                    const bool has_body = transfer_encoding || req.headers().content_length() > 0;
+                    accepts_chunked = req.http_version() != "HTTP/1.0";
+
+                    // HTTP/1.0 clients do not know 100 Continue, so their expectations are ignored.
+                    const auto expect = accepts_chunked ? req.headers().get("expect") : std::nullopt;
+
+                    enter_request_stage(request_stage::routing);
+
+                    route_options options{};
+                    std::optional<http_response> rejection{};
+                    if (refused) {
+                        rejection = app->on_request_error(*refused);
+                    } else if (self->metrics_ && req.method() == "GET" && req.path() == *self->options_.metrics_path) {
+                        rejection = self->metrics_response();
+                    } else {
+                        rejection = app->on_headers(req, options);
+                    }
+
+                    const auto max_body_size = options.max_body_size.value_or(self->options_.max_body_size);
+
+                    if (rejection) {
+                        // Rejected by the application, or answered by the server.
+                    } else if (expect && !equals_lowercase(*expect, "100-continue")) {
+                        rejection = http_response::html(417, "417 Expectation Failed");
+                    } else if (req.headers().content_length() > max_body_size) {
+                        refused = request_error::payload_too_large;
+                        rejection = app->on_request_error(*refused);
+                    }
+
+                    if (rejection) {
+                        // The body is left unread (or, after `expect: 100-continue`, unsent), so the connection cannot be reused.
+                        // Neither can it after a malformed request, whose framing cannot be trusted.
+                        if (has_body || refused) {
+                            keep_alive = false;
+                        }
+
+                        res = std::move(*rejection);
+                    } else {
+                        enter_request_stage(request_stage::body);
+
+                        if (transfer_encoding) {
+                            reader = &chunked_body.emplace(conn, max_body_size);
+                        } else {
+                            reader = &content_length_body.emplace(conn, req.headers().content_length());
+                        }
+
+                        // 100 Continue goes out when the body is first read from the socket, so a streaming handler that
+                        // answers without reading the body never asks for it.
+                        conn.continue_pending = expect.has_value();
+
+                        if (options.stream_body) {
+                            req.set_body_reader(reader);
+                        } else if (options.body_file_directory) {
+                            body_file = util::open_temporary_file(*options.body_file_directory);
+
+                            std::size_t size = 0;
+                            if (content_length_body) {
+                                size = content_length_body->splice_to(body_file.get());
+                            } else {
+                                // A chunked body has to be decoded on the way.
+                                std::byte buffer[16 * 1024];
+                                while (const auto n = reader->read_some(buffer)) {
+                                    write_all(body_file.get(), std::span{buffer, n});
+                                    size += n;
+                                }
+                            }
+
+                            ::lseek(body_file.get(), 0, SEEK_SET);
+                            req.set_body_file(body_file.get(), size);
+                        } else if (chunked_body) {
+                            std::pmr::vector<std::byte> body(arena.resource());
+                            for (;;) {
+                                const auto n = body.size();
+                                body.resize(n + 4096);
+
+                                const auto size_read = reader->read_some(std::span{body}.subspan(n));
+                                body.resize(n + size_read);
+
+                                if (size_read == 0) {
+                                    break;
+                                }
+                            }
+
+                            req.set_body(std::move(body));
+                        } else {
+                            std::pmr::vector<std::byte> body(req.headers().content_length(), arena.resource());
+                            for (std::size_t n = 0; n < body.size();) {
+                                const auto size_read = content_length_body->receive(std::span{body}.subspan(n));
+                                if (size_read == 0) {
+                                    if (deadline.expired()) {
+                                        throw request_timeout{};
+                                    }
+                                    return; // Connection closed.
+                                }
+
+                                n += size_read;
+                            }
+
+                            req.set_body(std::move(body));
+                        }
+
+                        enter_request_stage(request_stage::handler);
+
+                        res = app->on_request(req);
+                        matched_route = req.matched_route();
+                    }
+                }
+            } catch (const request_timeout&) {
+                res = http_response::html(408, "408 Request Timeout");
+                keep_alive = false;
+            } catch (const request_error_exception& e) {
+                // The body cannot be framed, so the connection cannot be reused.
+                refused = e.error();
+                res = app->on_request_error(*refused);
+                keep_alive = false;
             } catch (const std::exception& e) {
                 res = app->on_error(e);
             } catch (...) {
                 res = app->on_unknown_error();
             }
 
+            enter_request_stage(request_stage::serialize);
+
             try {
-                res.headers().set("connection", keep_alive ? "keep-alive" : "close");
+                // Skip what a streaming handler left unread so that the next request is read from its start.
+                if (reader && !reader->skip(max_skipped_body_size)) {
+                    keep_alive = false;
+                }
+
+                // An unsent 100 Continue is moot once the final response goes out.
+                conn.continue_pending = false;
+
+                if (res.is_streamed() && !accepts_chunked) {
+                    const auto writer = res.stream_writer();
+                    res.stream(nullptr);
+
+                    buffering_writer buffering{res};
+                    writer(buffering);
+                }
+
+                // A prebuilt response is queued like any other, with its shared body in place of the response's.
+                const auto* prebuilt = res.prebuilt();
+                const auto body = prebuilt ? prebuilt->body() : res.body();
+
+                // Copied from the line the timer thread formats once per second.
+                const auto date = self->date_.get();
+                const std::string_view date_line{date.data(), date.size()};
+
+                if (prebuilt) {
+                    conn.output.write(prebuilt->head());
+                    conn.output.write(date_line);
+                    conn.output.write(prebuilt_response::connection_line(keep_alive));
+                } else {
+                    const auto date_value = date_line.substr(http1::date_header::prefix.size(), http1::date_size);
+                    const auto http1_res = convert_to_http1_response(res, headers, date_value, keep_alive ? "keep-alive" : "close");
 
-                const auto http1_res = convert_to_http1_response(res, headers);
+                    std::pmr::string head{arena.resource()};
+                    http1::write_response_head(head, http1_res);
+                    conn.output.write(head);
+                }
+
+                if (res.is_streamed()) {
+                    // Hold partial segments back between flushes; uncorking sends the tail.
+                    const bool cork = tcp && options->cork;
+                    if (cork) {
+                        client_socket.set_cork(true);
+                    }
 
-                std::ostringstream oss;
-                http1::write_response(oss, http1_res);
+                    // The status line may be out already, so a failing writer can only abort the connection.
+                    const bool keep = std::exchange(keep_alive, false);
+
+                    chunked_writer writer{conn, self->options_.output_high_water_mark};
+                    res.stream_writer()(writer);
+                    writer.finish();
+                    conn.flush();
+
+                    if (cork) {
+                        client_socket.set_cork(false);
+                    }
 
-                const auto s = oss.str();
-                client_socket.send(s.data(), s.size());
+                    keep_alive = keep;
+                } else if (keep_alive && !conn.buffered().empty()) {
+                    // The next request is waiting already; its response joins this one unless the queue is full.
+                    // The body is copied since the response dies before the queue is sent.
+                    conn.output.write(body);
+
+                    if (conn.output.size() >= self->options_.output_high_water_mark) {
+                        conn.flush();
+                    }
+                } else {
+                    conn.output.write_zero_copy(body);
+                    conn.flush();
+
+                    // The body is on the heap with the response, which dies at the end of this iteration, unless the
+                    // handler built the response on the arena or it is prebuilt and shared. The kernel must be done
+                    // with its pages before any of those is freed or reset.
+                    conn.release_zero_copy();
+                }
             } catch (...) {
+                keep_alive = false;
             }
+
+            stats.record_request(matched_route, method, res.status_code(), refused);
         } while (keep_alive);
     }
 } // namespace mio
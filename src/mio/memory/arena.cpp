@@ -0,0 +1,83 @@
+#include "mio/memory/arena.hpp"
+
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace mio::memory {
+    namespace {
+        thread_local std::pmr::memory_resource* current = nullptr;
+
+        // Recycles arena blocks across connections so that accepting a connection does not hit malloc either.
+        class block_pool {
+        public:
+            static constexpr std::size_t max_pooled_blocks = 256;
+
+            ~block_pool() noexcept {
+                for (const auto block : blocks_) {
+                    ::operator delete(block, arena::block_size, std::align_val_t{alignof(std::max_align_t)});
+                }
+            }
+
+            std::byte* acquire() {
+                {
+                    std::lock_guard lock{mutex_};
+                    if (!blocks_.empty()) {
+                        const auto block = blocks_.back();
+                        blocks_.pop_back();
+                        return block;
+                    }
+                }
+
+                return static_cast<std::byte*>(::operator new(arena::block_size, std::align_val_t{alignof(std::max_align_t)}));
+            }
+
+            void release(std::byte* block) noexcept {
+                {
+                    std::lock_guard lock{mutex_};
+                    if (blocks_.size() < max_pooled_blocks) {
+                        try {
+                            blocks_.push_back(block);
+                            return;
+                        } catch (...) {
+                        }
+                    }
+                }
+
+                ::operator delete(block, arena::block_size, std::align_val_t{alignof(std::max_align_t)});
+            }
+
+        private:
+            std::mutex mutex_;
+            std::vector<std::byte*> blocks_;
+        };
+
+        block_pool& pool() {
+            static block_pool instance{};
+            return instance;
+        }
+    } // namespace
+
+    std::pmr::memory_resource* current_resource() noexcept {
+        return current != nullptr ? current : std::pmr::get_default_resource();
+    }
+
+    resource_scope::resource_scope(std::pmr::memory_resource* resource) noexcept
+        : previous_(std::exchange(current, resource)) {
+    }
+
+    resource_scope::~resource_scope() noexcept {
+        current = previous_;
+    }
+
+    arena::arena()
+        : block_(pool().acquire())
+        , resource_(block_, block_size) {
+    }
+
+    arena::~arena() noexcept {
+        resource_.release();
+        pool().release(block_);
+    }
+} // namespace mio::memory
@@ -0,0 +1,439 @@
+#include "mio/metrics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <map>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "mio/router.hpp"
+
+namespace mio {
+    namespace {
+        constexpr std::size_t method_count = std::size(metrics::methods);
+
+        // The last bucket is +Inf.
+        constexpr std::size_t latency_bucket_count = std::size(metrics::latency_buckets_us) + 1;
+
+        // Series a shard can hold; what does not fit is counted as dropped.
+        constexpr std::size_t series_capacity = 256;
+
+        constexpr request_error request_errors[] = {
+            request_error::bad_request,
+            request_error::payload_too_large,
+            request_error::header_fields_too_large,
+            request_error::http_version_not_supported,
+        };
+
+        constexpr std::string_view request_error_names[] = {
+            "bad_request",
+            "payload_too_large",
+            "header_fields_too_large",
+            "http_version_not_supported",
+        };
+
+        // Threads take the shared shards in turn.
+        std::atomic<std::size_t> next_thread_index{0};
+        thread_local const std::size_t thread_index = next_thread_index.fetch_add(1, std::memory_order_relaxed);
+
+        // Routes are told apart by address, which leaves the low bits free for the method.
+        static_assert(alignof(route) >= method_count);
+
+        [[nodiscard]] std::uintptr_t key_of(const route* route, std::size_t method) noexcept {
+            return reinterpret_cast<std::uintptr_t>(route) | method;
+        }
+
+        // A counter of a claimed shard has one writer, which spares the atomic read-modify-write.
+        void add(std::atomic<std::uint64_t>& counter, std::uint64_t n, bool exclusive) noexcept {
+            if (exclusive) {
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            } else {
+                counter.fetch_add(n, std::memory_order_relaxed);
+            }
+        }
+
+        [[nodiscard]] std::uint64_t load(const std::atomic<std::uint64_t>& counter) noexcept {
+            return counter.load(std::memory_order_relaxed);
+        }
+
+        void write_number(std::string& output, auto value) {
+            char buffer[32];
+            const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+            output.append(buffer, end);
+        }
+
+        // Bucket bounds are label values, so they are written the same way every time, without exponents.
+        void write_bound(std::string& output, std::uint64_t us) {
+            char buffer[32];
+            const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), static_cast<double>(us) / 1e6, std::chars_format::fixed);
+            output.append(buffer, end);
+        }
+
+        // Label values escape backslashes, double quotes and line feeds.
+        void write_label(std::string& output, std::string_view name, std::string_view value) {
+            output += name;
+            output += "=\"";
+            for (const auto c : value) {
+                if (c == '\\' || c == '"') {
+                    output += '\\';
+                    output += c;
+                } else if (c == '\n') {
+                    output += "\\n";
+                } else {
+                    output += c;
+                }
+            }
+            output += '"';
+        }
+
+        void write_header(std::string& output, std::string_view name, std::string_view type, std::string_view help) {
+            output += "# HELP ";
+            output += name;
+            output += ' ';
+            output += help;
+            output += "\n# TYPE ";
+            output += name;
+            output += ' ';
+            output += type;
+            output += '\n';
+        }
+    } // namespace
+
+    // A few hundred bytes, so that every shard can afford one for each route.
+    struct metrics::series {
+        struct status_count {
+            std::atomic<std::int32_t> status{0}; // 0 while the entry is free.
+            std::atomic<std::uint64_t> count{0};
+        };
+
+        explicit series(std::uintptr_t key, const route* route, std::size_t method)
+            : key(key)
+            , route(route != nullptr ? route->pattern : std::string{})
+            , method(metrics::methods[method]) {
+        }
+
+        // The count of `status`, claiming an entry for it on first use. Returns nullptr if every entry is taken.
+        std::atomic<std::uint64_t>* find_status(std::int32_t status) noexcept {
+            for (auto& s : statuses) {
+                auto current = s.status.load(std::memory_order_relaxed);
+                if (current == 0 && s.status.compare_exchange_strong(current, status, std::memory_order_relaxed)) {
+                    return &s.count;
+                }
+                if (current == status) {
+                    return &s.count;
+                }
+            }
+            return nullptr;
+        }
+
+        const std::uintptr_t key;
+        const std::string route;
+        const std::string_view method;
+        std::array<status_count, metrics::max_statuses> statuses{};
+        std::array<std::atomic<std::uint64_t>, latency_bucket_count> latencies{};
+        std::atomic<std::uint64_t> latency_sum_ns{0};
+    };
+
+    struct alignas(64) metrics::shard {
+        ~shard() noexcept {
+            for (auto& s : slots) {
+                delete s.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Open addressing; a slot is claimed once and never freed.
+        std::array<std::atomic<metrics::series*>, series_capacity> slots{};
+        std::array<std::atomic<std::uint64_t>, std::size(request_errors)> errors{};
+        std::atomic<std::uint64_t> bytes_received{0};
+        std::atomic<std::uint64_t> bytes_sent{0};
+        std::atomic<std::uint64_t> connections_opened{0};
+        std::atomic<std::uint64_t> connections_closed{0};
+        std::atomic<std::uint64_t> dropped{0};
+
+        // Held by the recorder writing to the shard, if it is one to be claimed.
+        std::atomic<bool> claimed{false};
+
+        // Finds the series of `key`, allocating it on first use. Returns nullptr if the shard is full.
+        metrics::series* find(const route* route, std::size_t method) noexcept {
+            const auto key = key_of(route, method);
+
+            auto index = static_cast<std::size_t>((key * 0x9e3779b97f4a7c15) >> (64 - std::bit_width(series_capacity - 1)));
+            for (std::size_t probes = 0; probes < series_capacity; probes++, index = (index + 1) % series_capacity) {
+                auto* s = slots[index].load(std::memory_order_acquire);
+                if (s == nullptr) {
+                    metrics::series* created;
+                    try {
+                        created = new metrics::series{key, route, method};
+                    } catch (const std::bad_alloc&) {
+                        return nullptr;
+                    }
+
+                    if (slots[index].compare_exchange_strong(s, created, std::memory_order_acq_rel)) {
+                        return created;
+                    }
+                    delete created; // Another thread claimed the slot first; `s` is what it put there.
+                }
+
+                if (s->key == key) {
+                    return s;
+                }
+            }
+
+            return nullptr;
+        }
+
+        void record_request(const route* route, std::size_t method, std::int32_t status, std::chrono::nanoseconds latency, bool exclusive) noexcept {
+            auto* s = find(route, method);
+            if (s == nullptr) {
+                add(dropped, 1, exclusive);
+                return;
+            }
+
+            auto* count = s->find_status(status);
+            if (count == nullptr) {
+                add(dropped, 1, exclusive);
+                return;
+            }
+
+            const auto ns = static_cast<std::uint64_t>(std::max(latency.count(), std::chrono::nanoseconds::rep{0}));
+
+            // Most requests fall in the first buckets, so a linear search beats a binary one.
+            std::size_t bucket = 0;
+            while (bucket < std::size(metrics::latency_buckets_us) && ns > metrics::latency_buckets_us[bucket] * 1000) {
+                bucket++;
+            }
+
+            add(*count, 1, exclusive);
+            add(s->latencies[bucket], 1, exclusive);
+            add(s->latency_sum_ns, ns, exclusive);
+        }
+
+        void record_request_error(request_error error, bool exclusive) noexcept {
+            const auto it = std::ranges::find(request_errors, error);
+            if (it != std::end(request_errors)) {
+                add(errors[static_cast<std::size_t>(it - std::begin(request_errors))], 1, exclusive);
+            }
+        }
+
+        void record_bytes(std::uint64_t received, std::uint64_t sent, bool exclusive) noexcept {
+            if (received > 0) {
+                add(bytes_received, received, exclusive);
+            }
+            if (sent > 0) {
+                add(bytes_sent, sent, exclusive);
+            }
+        }
+    };
+
+    metrics::recorder::recorder(metrics& m) noexcept
+        : shard_(nullptr)
+        , exclusive_(false) {
+        for (const auto& s : m.exclusive_shards_) {
+            if (!s->claimed.load(std::memory_order_relaxed) && !s->claimed.exchange(true, std::memory_order_acquire)) {
+                shard_ = s.get();
+                exclusive_ = true;
+                return;
+            }
+        }
+
+        shard_ = &m.shared_shard();
+    }
+
+    metrics::recorder::~recorder() noexcept {
+        if (exclusive_) {
+            // Hands what was recorded over to the next recorder claiming the shard.
+            shard_->claimed.store(false, std::memory_order_release);
+        }
+    }
+
+    void metrics::recorder::record_request(const route* route, std::size_t method, std::int32_t status, std::chrono::nanoseconds latency) noexcept {
+        shard_->record_request(route, method, status, latency, exclusive_);
+    }
+
+    void metrics::recorder::record_request_error(request_error error) noexcept {
+        shard_->record_request_error(error, exclusive_);
+    }
+
+    void metrics::recorder::record_bytes(std::uint64_t received, std::uint64_t sent) noexcept {
+        shard_->record_bytes(received, sent, exclusive_);
+    }
+
+    metrics::metrics(std::size_t shard_count) {
+        if (shard_count == 0) {
+            shard_count = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        shared_shards_.resize(std::bit_ceil(shard_count));
+        for (auto& s : shared_shards_) {
+            s = std::make_unique<shard>();
+        }
+
+        exclusive_shards_.resize(shard_count * 2);
+        for (auto& s : exclusive_shards_) {
+            s = std::make_unique<shard>();
+        }
+    }
+
+    metrics::~metrics() noexcept = default;
+
+    std::size_t metrics::method_index(std::string_view method) noexcept {
+        const auto it = std::ranges::find(methods, method);
+        return it != std::end(methods) ? static_cast<std::size_t>(it - std::begin(methods)) : method_count - 1;
+    }
+
+    metrics::shard& metrics::shared_shard() noexcept {
+        return *shared_shards_[thread_index & (shared_shards_.size() - 1)];
+    }
+
+    void metrics::record_request(const route* route, std::size_t method, std::int32_t status, std::chrono::nanoseconds latency) noexcept {
+        shared_shard().record_request(route, method, status, latency, false);
+    }
+
+    void metrics::record_request_error(request_error error) noexcept {
+        shared_shard().record_request_error(error, false);
+    }
+
+    void metrics::record_bytes(std::uint64_t received, std::uint64_t sent) noexcept {
+        shared_shard().record_bytes(received, sent, false);
+    }
+
+    // A connection may close on another shard than it opened on (with serve() from several threads in turn), so the
+    // gauge is the difference of two counters summed over every shard.
+    void metrics::connection_opened() noexcept {
+        add(shared_shard().connections_opened, 1, false);
+    }
+
+    void metrics::connection_closed() noexcept {
+        add(shared_shard().connections_closed, 1, false);
+    }
+
+    void metrics::write_prometheus(std::string& output) const {
+        struct merged_series {
+            std::map<std::int32_t, std::uint64_t> statuses{};
+            std::array<std::uint64_t, latency_bucket_count> latencies{};
+            std::uint64_t latency_sum_ns = 0;
+        };
+
+        // Sorted by route and method, so that scrapes list the series in the same order.
+        std::map<std::pair<std::string_view, std::string_view>, merged_series> merged{};
+        std::array<std::uint64_t, std::size(request_errors)> errors{};
+        std::uint64_t bytes_received = 0;
+        std::uint64_t bytes_sent = 0;
+        std::uint64_t connections_opened = 0;
+        std::uint64_t connections_closed = 0;
+        std::uint64_t dropped = 0;
+
+        const auto merge_shard = [&](const shard& shard) {
+            for (const auto& slot : shard.slots) {
+                const auto* s = slot.load(std::memory_order_acquire);
+                if (s == nullptr) {
+                    continue;
+                }
+
+                auto& m = merged[{s->route, s->method}];
+                for (const auto& status : s->statuses) {
+                    if (const auto code = status.status.load(std::memory_order_relaxed); code != 0) {
+                        m.statuses[code] += load(status.count);
+                    }
+                }
+                for (std::size_t i = 0; i < latency_bucket_count; i++) {
+                    m.latencies[i] += load(s->latencies[i]);
+                }
+                m.latency_sum_ns += load(s->latency_sum_ns);
+            }
+
+            for (std::size_t i = 0; i < errors.size(); i++) {
+                errors[i] += load(shard.errors[i]);
+            }
+
+            bytes_received += load(shard.bytes_received);
+            bytes_sent += load(shard.bytes_sent);
+            connections_opened += load(shard.connections_opened);
+            connections_closed += load(shard.connections_closed);
+            dropped += load(shard.dropped);
+        };
+
+        for (const auto& shard : shared_shards_) {
+            merge_shard(*shard);
+        }
+        for (const auto& shard : exclusive_shards_) {
+            merge_shard(*shard);
+        }
+
+        const auto write_series_labels = [&](std::string_view route, std::string_view method) {
+            write_label(output, "route", route);
+            output += ',';
+            write_label(output, "method", method);
+        };
+
+        write_header(output, "mio_http_requests_total", "counter", "Requests answered, by route template, method and status.");
+        for (const auto& [labels, m] : merged) {
+            for (const auto& [status, count] : m.statuses) {
+                output += "mio_http_requests_total{";
+                write_series_labels(labels.first, labels.second);
+                output += ",status=\"";
+                write_number(output, status);
+                output += "\"} ";
+                write_number(output, count);
+                output += '\n';
+            }
+        }
+
+        write_header(output, "mio_http_request_duration_seconds", "histogram", "Time from the start of a request until its response is sent, by route template and method.");
+        for (const auto& [labels, m] : merged) {
+            // Buckets are cumulative.
+            std::uint64_t count = 0;
+            for (std::size_t i = 0; i < latency_bucket_count; i++) {
+                count += m.latencies[i];
+
+                output += "mio_http_request_duration_seconds_bucket{";
+                write_series_labels(labels.first, labels.second);
+                output += ",le=\"";
+                if (i < std::size(latency_buckets_us)) {
+                    write_bound(output, latency_buckets_us[i]);
+                } else {
+                    output += "+Inf";
+                }
+                output += "\"} ";
+                write_number(output, count);
+                output += '\n';
+            }
+
+            output += "mio_http_request_duration_seconds_sum{";
+            write_series_labels(labels.first, labels.second);
+            output += "} ";
+            write_number(output, static_cast<double>(m.latency_sum_ns) / 1e9);
+            output += "\nmio_http_request_duration_seconds_count{";
+            write_series_labels(labels.first, labels.second);
+            output += "} ";
+            write_number(output, count);
+            output += '\n';
+        }
+
+        write_header(output, "mio_http_request_errors_total", "counter", "Requests refused as malformed, too large or of an unsupported HTTP version, by error.");
+        for (std::size_t i = 0; i < errors.size(); i++) {
+            output += "mio_http_request_errors_total{";
+            write_label(output, "error", request_error_names[i]);
+            output += "} ";
+            write_number(output, errors[i]);
+            output += '\n';
+        }
+
+        const auto write_metric = [&](std::string_view name, std::string_view type, std::string_view help, std::uint64_t value) {
+            write_header(output, name, type, help);
+            output += name;
+            output += ' ';
+            write_number(output, value);
+            output += '\n';
+        };
+
+        write_metric("mio_http_received_bytes_total", "counter", "Bytes received from clients.", bytes_received);
+        write_metric("mio_http_sent_bytes_total", "counter", "Bytes sent to clients.", bytes_sent);
+        write_metric("mio_http_active_connections", "gauge", "Connections being served.", connections_opened - std::min(connections_closed, connections_opened));
+        write_metric("mio_metrics_dropped_requests_total", "counter", "Requests left out of the metrics because a shard had no room for their series or status.", dropped);
+    }
+} // namespace mio
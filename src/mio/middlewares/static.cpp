@@ -51,7 +51,7 @@ namespace mio::middlewares {
     }
 
     void static_::operator()(http_request& req, http_response& res) const {
-        if ((req.method() != "GET" && req.method() != "HEAD") || res.status_code() != 404) {
+        if (res.status_code() != 404) {
             return;
         }
 
@@ -65,30 +65,56 @@ namespace mio::middlewares {
         }
 
         path.remove_prefix(base.size());
-        if (!path.empty() && !path.starts_with('/')) {
+
+        auto f = find_file(req, path);
+        if (!f) {
             return;
         }
 
+        res.set_status_code(200);
+        res.headers().set("content-type", estimate_content_type(f->path));
+        res.body(f->content);
+    }
+
+    std::optional<http_response> static_::operator()(http_request& req, std::string_view path) const {
+        auto f = find_file(req, path);
+        if (!f) {
+            return std::nullopt;
+        }
+
+        http_headers headers{};
+        headers.set("content-type", estimate_content_type(f->path));
+
+        return http_response{200, std::move(headers), f->content};
+    }
+
+    std::optional<static_::file> static_::find_file(const http_request& req, std::string_view path) const {
+        if (req.method() != "GET" && req.method() != "HEAD") {
+            return std::nullopt;
+        }
+
+        if (!path.empty() && !path.starts_with('/')) {
+            return std::nullopt;
+        }
+
         // path == "" or path == "/XXX"
         auto file_path = path_;
         file_path.concat(path); // not path::append()
         file_path = file_path.lexically_normal();
 
         if (!file_path.native().starts_with(path_.native())) {
-            return;
+            return std::nullopt;
         }
 
         if (std::filesystem::is_directory(file_path)) {
             file_path /= "index.html";
         }
 
-        const auto content = read_file(file_path);
+        auto content = read_file(file_path);
         if (!content) {
-            return;
+            return std::nullopt;
         }
 
-        res.set_status_code(200);
-        res.headers().set("content-type", estimate_content_type(file_path));
-        res.body(*content);
+        return file{std::move(file_path), std::move(*content)};
     }
 } // namespace mio::middlewares
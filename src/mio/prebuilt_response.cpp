@@ -0,0 +1,39 @@
+#include "mio/prebuilt_response.hpp"
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include "mio/http1/response.hpp"
+#include "mio/http_request.hpp"
+#include "mio/http_response.hpp"
+
+namespace mio {
+    prebuilt_response::prebuilt_response(const http_response& res)
+        : status_code_(res.status_code()) {
+        assert(!res.is_streamed());
+
+        // Both are added when the response is sent.
+        std::vector<http1::header> headers{};
+        for (const auto& [key, value] : res.headers().entries()) {
+            if (key != "connection" && key != "date") {
+                headers.push_back(http1::header{key, value});
+            }
+        }
+
+        std::pmr::string head{std::pmr::new_delete_resource()};
+        http1::write_response_head(head, http1::response{"HTTP/1.1", status_code_, headers, res.body()});
+
+        // The head ends with an empty line, which connection_line() supplies instead.
+        head.resize(head.size() - 2);
+        head_ = head;
+
+        body_ = res.body_as_text();
+    }
+
+    request_handler prebuilt(const http_response& res) {
+        return [prebuilt = std::make_shared<const prebuilt_response>(res)](http_request&) {
+            return http_response{prebuilt->status_code(), prebuilt};
+        };
+    }
+} // namespace mio
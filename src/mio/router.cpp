@@ -1,10 +1,50 @@
 #include "mio/router.hpp"
 
+#include <algorithm>
+#include <memory_resource>
+#include <string>
+
 #include "mio/http_request.hpp"
 #include "mio/http_response.hpp"
+#include "mio/request_stage.hpp"
 #include "mio/uri.hpp"
+#include "mio/util/path.hpp"
 
 namespace mio {
+    namespace {
+        // Room for a lookup: its parameters, and the segments of a path to decode. On the stack, unless the path is
+        // long or has many parameters.
+        class lookup_buffer {
+        public:
+            explicit lookup_buffer(std::size_t path_size) {
+                if (path_size > sizeof(path_)) {
+                    heap_path_.resize(path_size);
+                }
+            }
+
+            // Uncopyable and unmovable
+            lookup_buffer(const lookup_buffer&) = delete;
+            lookup_buffer(lookup_buffer&&) = delete;
+
+            lookup_buffer& operator=(const lookup_buffer&) = delete;
+            lookup_buffer& operator=(lookup_buffer&&) = delete;
+
+            [[nodiscard]] char* path() noexcept {
+                return heap_path_.empty() ? path_ : heap_path_.data();
+            }
+
+            [[nodiscard]] std::pmr::memory_resource* params() noexcept {
+                return &params_resource_;
+            }
+
+        private:
+            char path_[512];
+            std::string heap_path_;
+            std::byte params_[256];
+            std::pmr::monotonic_buffer_resource params_resource_{params_, sizeof(params_)};
+        };
+    } // namespace
+
     routing_tree::routing_tree(std::string_view name, std::optional<std::string>&& placeholder)
         : name_(name)
         , children_()
@@ -13,7 +53,11 @@ namespace mio {
         , placeholder_(std::move(placeholder)) {
     }
 
-    void routing_tree::insert(std::string_view path, const std::string& method, request_handler&& handler) {
+    void routing_tree::insert(std::string_view path, const std::string& method, request_handler&& handler, const route_options& options) {
+        insert(path, method, route{std::move(handler), options, std::string{path}});
+    }
+
+    void routing_tree::insert(std::string_view path, const std::string& method, route&& r) {
         // Skips over the first '/'.
         // "/foo/bar" -> "foo/bar"
         if (path.starts_with('/')) {
@@ -22,7 +66,7 @@ namespace mio {
 
         if (path.empty()) {
             // Register the request handler.
-            if (const auto [it, inserted] = actions_.try_emplace(method, std::move(handler)); !inserted) {
+            if (const auto [it, inserted] = actions_.try_emplace(method, std::move(r)); !inserted) {
                 throw std::runtime_error{"routing is already registered"};
             }
             return;
@@ -39,7 +83,7 @@ namespace mio {
                 it = children_.emplace(std::string_view{child->name_}, std::move(child)).first;
             }
 
-            it->second->insert(tail, method, std::move(handler));
+            it->second->insert(tail, method, std::move(r));
         } else {
             const auto placeholder = std::string_view{segment}.substr(1);
 
@@ -56,15 +100,23 @@ namespace mio {
                 node = wildcards_.back().get();
             }
 
-            node->insert(tail, method, std::move(handler));
+            node->insert(tail, method, std::move(r));
+        }
+    }
+
+    const request_handler* routing_tree::find(std::string_view path, std::string_view method, route_params& params, char* buffer) const {
+        if (const auto r = find_route(path, method, params, buffer); r && *r) {
+            return &(*r)->handler;
         }
+        return nullptr;
     }
 
-    const request_handler* routing_tree::find(std::string_view path, const std::string& method, std::vector<std::pair<std::string_view, std::string>>& params) const {
+    request_result<const route*> routing_tree::find_route(std::string_view path, std::string_view method, route_params& params, char* buffer) const {
         // Skips over the first '/'.
         // "/foo/bar" -> "foo/bar"
         if (path.starts_with('/')) {
             path.remove_prefix(1);
+            buffer++;
         }
 
         if (path.empty()) {
@@ -77,23 +129,28 @@ namespace mio {
         const auto sep_index = path.find('/');
         const auto segment = path.substr(0, sep_index);
         const auto tail = path.substr(segment.size());
+        char* const tail_buffer = buffer + segment.size();
 
         if (const auto it = children_.find(segment); it != std::end(children_)) {
-            if (const auto handler = it->second->find(tail, method, params)) {
-                return handler;
+            if (const auto r = it->second->find_route(tail, method, params, tail_buffer); !r || *r) {
+                return r;
             }
         }
 
-        for (const auto& child : wildcards_) {
-            auto param = decode_uri(segment, true);
-            if (!param) {
-                throw std::runtime_error{"invalid request"};
-            }
+        if (wildcards_.empty()) {
+            return nullptr;
+        }
 
-            params.emplace_back(*child->placeholder_, std::move(*param));
+        const auto param = decode_uri(segment, true, buffer);
+        if (!param) {
+            return util::unexpected{request_error::bad_request};
+        }
+
+        for (const auto& child : wildcards_) {
+            params.emplace_back(*child->placeholder_, *param);
 
-            if (const auto handler = child->find(tail, method, params)) {
-                return handler;
+            if (const auto r = child->find_route(tail, method, params, tail_buffer); !r || *r) {
+                return r;
             }
 
             params.pop_back();
@@ -102,16 +159,76 @@ namespace mio {
         return nullptr;
     }
 
-    std::optional<http_response> router::handle_request(http_request& req) const {
-        std::vector<std::pair<std::string_view, std::string>> params{};
-        if (const auto handler = tree_.find(req.path(), req.method(), params)) {
-            for (auto&& [key, value] : params) {
-                req.set_param(std::string{key}, std::move(value));
+    void router::mount(std::string_view path, mount_handler&& handler) {
+        auto prefix = util::normalize_prefix(path);
+
+        // Keep the longest prefix first so that nested mounts take precedence.
+        const auto it = std::ranges::find_if(mounts_, [&](const mount_point& m) {
+            return m.prefix.size() < prefix.size();
+        });
+        mounts_.insert(it, mount_point{std::move(prefix), std::move(handler)});
+    }
+
+    request_result<std::optional<http_response>> router::handle_request(http_request& req) const {
+        // Within a server, the lookup is accounted to routing rather than to the handler stage around it, which is
+        // back when this returns, whether a route matched or not.
+        const request_stage_switch routing{request_stage::routing};
+        const bool staged = current_request_stage() != request_stage::idle;
+
+        // Routes come before mounts, which may be slow to miss, such as static files looked up on disk.
+        lookup_buffer buffer{req.path().size()};
+        route_params params{buffer.params()};
+        const auto r = tree_.find_route(req.path(), req.method(), params, buffer.path());
+
+        if (r && *r) {
+            for (const auto& [key, value] : params) {
+                req.set_param(key, value);
+            }
+
+            req.set_matched_route(*r);
+
+            if (staged) {
+                enter_request_stage(request_stage::handler);
             }
 
-            return (*handler)(req);
+            return std::optional<http_response>{(*r)->handler(req)};
+        }
+
+        if (staged) {
+            enter_request_stage(request_stage::handler);
+        }
+
+        const auto path = req.path();
+        for (const auto& [prefix, handler] : mounts_) {
+            if (!util::has_path_prefix(path, prefix)) {
+                continue;
+            }
+
+            if (auto res = handler(req, path.substr(prefix.size()))) {
+                return res;
+            }
+        }
+
+        // A path the routes cannot decode may still be a mount's.
+        if (!r) {
+            return util::unexpected{r.error()};
+        }
+
+        return std::optional<http_response>{};
+    }
+
+    request_result<route_options> router::find_options(const http_request& req) const {
+        if (!has_route_options_) {
+            return route_options{};
+        }
+
+        lookup_buffer buffer{req.path().size()};
+        route_params params{buffer.params()};
+        const auto r = tree_.find_route(req.path(), req.method(), params, buffer.path());
+        if (!r) {
+            return util::unexpected{r.error()};
         }
 
-        return std::nullopt;
+        return *r ? (*r)->options : route_options{};
     }
 } // namespace mio
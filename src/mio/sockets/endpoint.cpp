@@ -0,0 +1,137 @@
+#include "mio/sockets/endpoint.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+
+namespace mio::sockets {
+    endpoint::endpoint(const ::sockaddr* addr, ::socklen_t size) noexcept
+        : size_(std::min<::socklen_t>(size, sizeof(storage_))) {
+        std::memcpy(&storage_, addr, size_);
+    }
+
+    endpoint endpoint::any(std::uint16_t port) noexcept {
+        ::sockaddr_in6 addr{};
+        addr.sin6_family = AF_INET6;
+        addr.sin6_addr = in6addr_any;
+        addr.sin6_port = htons(port);
+
+        return endpoint{reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr)};
+    }
+
+    endpoint endpoint::any_v4(std::uint16_t port) noexcept {
+        ::sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+
+        return endpoint{reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr)};
+    }
+
+    endpoint endpoint::inet(std::string_view address, std::uint16_t port) {
+        char buffer[INET6_ADDRSTRLEN];
+        if (address.size() >= sizeof(buffer)) {
+            throw std::runtime_error{"invalid address"};
+        }
+
+        std::memcpy(buffer, address.data(), address.size());
+        buffer[address.size()] = '\0';
+
+        if (::sockaddr_in addr{}; ::inet_pton(AF_INET, buffer, &addr.sin_addr) == 1) {
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            return endpoint{reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr)};
+        }
+
+        if (::sockaddr_in6 addr{}; ::inet_pton(AF_INET6, buffer, &addr.sin6_addr) == 1) {
+            addr.sin6_family = AF_INET6;
+            addr.sin6_port = htons(port);
+            return endpoint{reinterpret_cast<const ::sockaddr*>(&addr), sizeof(addr)};
+        }
+
+        throw std::runtime_error{"invalid address"};
+    }
+
+    endpoint endpoint::local(std::string_view path) {
+        ::sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+
+        // A path needs its terminating NUL; an abstract name is the bytes after the leading NUL.
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error{"invalid address"};
+        }
+
+        std::memcpy(addr.sun_path, path.data(), path.size());
+
+        auto size = offsetof(::sockaddr_un, sun_path) + path.size();
+        if (path.front() == '@') {
+            addr.sun_path[0] = '\0';
+        } else {
+            size++;
+        }
+
+        return endpoint{reinterpret_cast<const ::sockaddr*>(&addr), static_cast<::socklen_t>(size)};
+    }
+
+    std::uint16_t endpoint::port() const noexcept {
+        switch (storage_.ss_family) {
+            case AF_INET:
+                return ntohs(reinterpret_cast<const ::sockaddr_in*>(&storage_)->sin_port);
+            case AF_INET6:
+                return ntohs(reinterpret_cast<const ::sockaddr_in6*>(&storage_)->sin6_port);
+            default:
+                return 0;
+        }
+    }
+
+    bool endpoint::is_any() const noexcept {
+        switch (storage_.ss_family) {
+            case AF_INET:
+                return reinterpret_cast<const ::sockaddr_in*>(&storage_)->sin_addr.s_addr == htonl(INADDR_ANY);
+            case AF_INET6:
+                return IN6_IS_ADDR_UNSPECIFIED(&reinterpret_cast<const ::sockaddr_in6*>(&storage_)->sin6_addr);
+            default:
+                return false;
+        }
+    }
+
+    std::string endpoint::path() const {
+        if (storage_.ss_family != AF_UNIX || size_ <= offsetof(::sockaddr_un, sun_path)) {
+            return {};
+        }
+
+        const auto* addr = reinterpret_cast<const ::sockaddr_un*>(&storage_);
+        const auto length = size_ - offsetof(::sockaddr_un, sun_path);
+
+        if (addr->sun_path[0] == '\0') {
+            return "@" + std::string{addr->sun_path + 1, length - 1};
+        }
+
+        return std::string{addr->sun_path, ::strnlen(addr->sun_path, length)};
+    }
+
+    std::string endpoint::to_string() const {
+        char buffer[INET6_ADDRSTRLEN];
+
+        switch (storage_.ss_family) {
+            case AF_INET:
+                ::inet_ntop(AF_INET, &reinterpret_cast<const ::sockaddr_in*>(&storage_)->sin_addr, buffer, sizeof(buffer));
+                return std::string{buffer} + ":" + std::to_string(port());
+
+            case AF_INET6:
+                ::inet_ntop(AF_INET6, &reinterpret_cast<const ::sockaddr_in6*>(&storage_)->sin6_addr, buffer, sizeof(buffer));
+                return "[" + std::string{buffer} + "]:" + std::to_string(port());
+
+            case AF_UNIX:
+                return "unix:" + path();
+
+            default:
+                return {};
+        }
+    }
+} // namespace mio::sockets
@@ -0,0 +1,151 @@
+#include "mio/sockets/output_buffer.hpp"
+
+#include <algorithm>
+
+#include <sys/uio.h>
+
+namespace mio::sockets {
+    namespace {
+        // iovecs per send. Plenty for a few pipelined responses; the rest goes in the next send.
+        constexpr std::size_t max_iovecs = 64;
+    } // namespace
+
+    void output_buffer::write(std::span<const std::byte> bytes) {
+        if (bytes.empty()) {
+            return;
+        }
+
+        // Extend the last segment if it is the tail of the storage.
+        if (segments_.size() > first_ && segments_.back().data == nullptr && segments_.back().offset + segments_.back().size == storage_.size()) {
+            segments_.back().size += bytes.size();
+        } else {
+            segments_.push_back(segment{nullptr, storage_.size(), bytes.size(), false});
+        }
+
+        storage_.insert(std::end(storage_), std::begin(bytes), std::end(bytes));
+        size_ += bytes.size();
+    }
+
+    void output_buffer::write_ref(std::span<const std::byte> bytes) {
+        if (bytes.size() <= copy_threshold) {
+            write(bytes);
+            return;
+        }
+
+        segments_.push_back(segment{bytes.data(), 0, bytes.size(), false});
+        size_ += bytes.size();
+    }
+
+    void output_buffer::write_zero_copy(std::span<const std::byte> bytes) {
+        if (!zero_copy_enabled() || bytes.size() < zero_copy_threshold_) {
+            write_ref(bytes);
+            return;
+        }
+
+        segments_.push_back(segment{bytes.data(), 0, bytes.size(), true});
+        size_ += bytes.size();
+    }
+
+    bool output_buffer::enable_zero_copy(std::size_t threshold) {
+        if (threshold == 0 || socket_.set_zero_copy(true) < 0) {
+            return false;
+        }
+
+        zero_copy_threshold_ = threshold;
+        return true;
+    }
+
+    bool output_buffer::reap_zero_copy() {
+        while (zero_copy_pending()) {
+            const auto completion = socket_.receive_zero_copy_completion();
+            if (!completion) {
+                return false;
+            }
+
+            zero_copy_completed_ += completion->last - completion->first + 1;
+
+            if (completion->copied) {
+                zero_copy_threshold_ = 0;
+            }
+        }
+
+        return true;
+    }
+
+    bool output_buffer::try_flush() {
+        // Unread notifications would wake every poll on the socket.
+        if (zero_copy_pending()) {
+            reap_zero_copy();
+        }
+
+        while (size_ > 0) {
+            auto n = send_some();
+            if (n == 0) {
+                return false; // Would block.
+            }
+
+            size_ -= n;
+            bytes_sent_ += n;
+
+            // Drop the segments that went out entirely and trim the one cut off.
+            while (n > 0) {
+                auto& s = segments_[first_];
+                const auto m = std::min(n, s.size);
+
+                s.offset += m;
+                s.size -= m;
+                n -= m;
+
+                if (s.size == 0) {
+                    first_++;
+                }
+            }
+        }
+
+        clear();
+        return true;
+    }
+
+    std::size_t output_buffer::send_some() {
+        // A zero-copy segment is sent alone, since everything sent along with it would be pinned as well.
+        const bool zero_copy = segments_[first_].zero_copy && zero_copy_enabled();
+
+        ::iovec iov[max_iovecs];
+        std::size_t count = 0;
+
+        for (auto i = first_; i < segments_.size() && count < max_iovecs; i++) {
+            const auto& s = segments_[i];
+            if (i > first_ && (zero_copy || (s.zero_copy && zero_copy_enabled()))) {
+                break;
+            }
+
+            const auto* data = s.data ? s.data + s.offset : storage_.data() + s.offset;
+            iov[count++] = ::iovec{const_cast<std::byte*>(data), s.size};
+        }
+
+        if (zero_copy) {
+            if (const auto n = socket_.send_some_zero_copy(std::span{iov, count})) {
+                if (*n > 0) {
+                    zero_copy_sent_++;
+                }
+                return *n;
+            }
+        }
+
+        return socket_.send_some(std::span{iov, count});
+    }
+
+    void output_buffer::flush() {
+        while (!try_flush()) {
+            socket_.wait_writable();
+        }
+    }
+
+    void output_buffer::clear() noexcept {
+        // The capacity is kept for the next responses on the connection.
+        storage_.clear();
+        segments_.clear();
+        first_ = 0;
+        size_ = 0;
+    }
+} // namespace mio::sockets
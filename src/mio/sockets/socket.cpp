@@ -1,11 +1,19 @@
 #include "mio/sockets/socket.hpp"
 
+#include <cerrno>
+#include <cstring>
 #include <system_error>
 #include <utility>
 
+#include <fcntl.h>
+#include <linux/errqueue.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <unistd.h>
 
+#include "mio/sockets/endpoint.hpp"
+
 namespace mio::sockets {
     socket::socket(int fd) noexcept
         : fd_(fd) {
@@ -13,11 +21,20 @@ namespace mio::sockets {
 
     socket::socket(address_family family, socket_type type)
         : fd_(-1) {
-        if ((fd_ = ::socket(static_cast<int>(family), static_cast<int>(type), 0)) < 0) {
+        if ((fd_ = ::socket(static_cast<int>(family), static_cast<int>(type) | SOCK_CLOEXEC, 0)) < 0) {
             throw std::system_error{errno, std::generic_category()};
         }
     }
 
+    std::pair<socket, socket> socket::pair() {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) < 0) {
+            throw std::system_error{errno, std::generic_category()};
+        }
+
+        return {socket{fds[0]}, socket{fds[1]}};
+    }
+
     socket::socket(socket&& socket) noexcept
         : fd_(std::exchange(socket.fd_, -1)) {
     }
@@ -38,17 +55,47 @@ namespace mio::sockets {
     }
 
     int socket::set_reuse_addr(bool value) {
-        const int reuseaddr = static_cast<int>(value);
-        return ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuseaddr, sizeof(int));
+        return set_option(SOL_SOCKET, SO_REUSEADDR, static_cast<int>(value));
+    }
+
+    int socket::set_keep_alive(bool value) {
+        return set_option(SOL_SOCKET, SO_KEEPALIVE, static_cast<int>(value));
+    }
+
+    int socket::set_send_buffer_size(int size_bytes) {
+        return set_option(SOL_SOCKET, SO_SNDBUF, size_bytes);
+    }
+
+    int socket::set_receive_buffer_size(int size_bytes) {
+        return set_option(SOL_SOCKET, SO_RCVBUF, size_bytes);
+    }
+
+    int socket::set_no_delay(bool value) {
+        return set_option(IPPROTO_TCP, TCP_NODELAY, static_cast<int>(value));
+    }
+
+    int socket::set_cork(bool value) {
+        return set_option(IPPROTO_TCP, TCP_CORK, static_cast<int>(value));
+    }
+
+    int socket::set_defer_accept(int timeout_seconds) {
+        return set_option(IPPROTO_TCP, TCP_DEFER_ACCEPT, timeout_seconds);
     }
 
-    void socket::listen(std::uint16_t port, int backlog) {
-        struct sockaddr_in addr {};
-        addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = htonl(INADDR_ANY);
-        addr.sin_port = htons(port);
+    int socket::set_fast_open(int queue_length) {
+        return set_option(IPPROTO_TCP, TCP_FASTOPEN, queue_length);
+    }
+
+    int socket::set_option(int level, int name, int value) {
+        return ::setsockopt(fd_, level, name, &value, sizeof(int));
+    }
+
+    int socket::set_v6_only(bool value) {
+        return set_option(IPPROTO_IPV6, IPV6_V6ONLY, static_cast<int>(value));
+    }
 
-        if (::bind(fd_, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+    void socket::listen(const endpoint& endpoint, int backlog) {
+        if (::bind(fd_, endpoint.data(), endpoint.size()) < 0) {
             throw std::system_error{errno, std::generic_category()};
         }
 
@@ -57,30 +104,203 @@ namespace mio::sockets {
         }
     }
 
-    socket socket::accept() {
-        const auto client_socket = ::accept(fd_, nullptr, nullptr);
-        if (client_socket < 0) {
+    endpoint socket::local_endpoint() const {
+        ::sockaddr_storage addr{};
+        ::socklen_t size = sizeof(addr);
+
+        if (::getsockname(fd_, reinterpret_cast<::sockaddr*>(&addr), &size) < 0) {
             throw std::system_error{errno, std::generic_category()};
         }
 
-        return socket{client_socket};
+        return endpoint{reinterpret_cast<const ::sockaddr*>(&addr), size};
+    }
+
+    std::optional<socket> socket::accept(endpoint& peer) {
+        for (;;) {
+            ::sockaddr_storage addr{};
+            ::socklen_t size = sizeof(addr);
+
+            const auto client_socket = ::accept4(fd_, reinterpret_cast<::sockaddr*>(&addr), &size, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (client_socket >= 0) {
+                // IPv4 clients of a dual-stack listener are reported as themselves, not as ::ffff:a.b.c.d.
+                if (const auto* addr6 = reinterpret_cast<const ::sockaddr_in6*>(&addr); addr.ss_family == AF_INET6 && IN6_IS_ADDR_V4MAPPED(&addr6->sin6_addr)) {
+                    ::sockaddr_in addr4{};
+                    addr4.sin_family = AF_INET;
+                    addr4.sin_port = addr6->sin6_port;
+                    std::memcpy(&addr4.sin_addr, addr6->sin6_addr.s6_addr + 12, sizeof(addr4.sin_addr));
+
+                    peer = endpoint{reinterpret_cast<const ::sockaddr*>(&addr4), sizeof(addr4)};
+                } else {
+                    peer = endpoint{reinterpret_cast<const ::sockaddr*>(&addr), size};
+                }
+
+                return socket{client_socket};
+            }
+
+            switch (errno) {
+                case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+                case EWOULDBLOCK:
+#endif
+                    return std::nullopt;
+
+                case EINTR:
+                case ECONNABORTED:
+                case EPROTO:
+                    continue; // The connection is gone, or nothing happened to the listener; try the next one.
+
+                default:
+                    throw std::system_error{errno, std::generic_category()};
+            }
+        }
     }
 
     std::size_t socket::receive(void* buffer, std::size_t size_bytes) {
-        ::ssize_t size_recv;
-        do {
-            size_recv = ::recv(fd_, buffer, size_bytes, 0);
-        } while (size_recv < 0 && errno == EINTR);
+        for (;;) {
+            const auto size_recv = ::recv(fd_, buffer, size_bytes, 0);
+            if (size_recv >= 0) {
+                return static_cast<std::size_t>(size_recv);
+            }
 
-        return static_cast<std::size_t>(size_recv);
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                wait(POLLIN);
+            } else if (errno != EINTR) {
+                throw std::system_error{errno, std::generic_category()};
+            }
+        }
     }
 
     std::size_t socket::send(const void* data, std::size_t size_bytes) {
-        ::ssize_t size_sent;
-        do {
-            size_sent = ::send(fd_, data, size_bytes, 0);
-        } while (size_sent < 0 && errno == EINTR);
+        const auto* p = static_cast<const std::byte*>(data);
+
+        for (std::size_t n = 0; n < size_bytes;) {
+            const auto size_sent = ::send(fd_, p + n, size_bytes - n, MSG_NOSIGNAL);
+            if (size_sent >= 0) {
+                n += static_cast<std::size_t>(size_sent);
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                wait(POLLOUT);
+            } else if (errno != EINTR) {
+                throw std::system_error{errno, std::generic_category()};
+            }
+        }
+
+        return size_bytes;
+    }
+
+    std::size_t socket::send_some(std::span<const ::iovec> buffers) {
+        ::msghdr message{};
+        message.msg_iov = const_cast<::iovec*>(buffers.data());
+        message.msg_iovlen = buffers.size();
+
+        for (;;) {
+            // sendmsg() rather than writev() for MSG_NOSIGNAL.
+            const auto size_sent = ::sendmsg(fd_, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (size_sent >= 0) {
+                return static_cast<std::size_t>(size_sent);
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            if (errno != EINTR) {
+                throw std::system_error{errno, std::generic_category()};
+            }
+        }
+    }
+
+    std::optional<std::size_t> socket::send_some_zero_copy(std::span<const ::iovec> buffers) {
+        ::msghdr message{};
+        message.msg_iov = const_cast<::iovec*>(buffers.data());
+        message.msg_iovlen = buffers.size();
+
+        for (;;) {
+            const auto size_sent = ::sendmsg(fd_, &message, MSG_NOSIGNAL | MSG_DONTWAIT | MSG_ZEROCOPY);
+            if (size_sent >= 0) {
+                return static_cast<std::size_t>(size_sent);
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            if (errno == ENOBUFS) {
+                return std::nullopt; // Over the optmem limit.
+            }
+            if (errno != EINTR) {
+                throw std::system_error{errno, std::generic_category()};
+            }
+        }
+    }
+
+    std::optional<zero_copy_completion> socket::receive_zero_copy_completion() {
+        for (;;) {
+            alignas(::cmsghdr) char control[CMSG_SPACE(sizeof(::sock_extended_err))];
+
+            ::msghdr message{};
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            if (::recvmsg(fd_, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return std::nullopt;
+                }
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error{errno, std::generic_category()};
+            }
+
+            for (auto* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+                const bool recverr = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+                if (!recverr) {
+                    continue;
+                }
+
+                ::sock_extended_err err;
+                std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+
+                if (err.ee_origin == SO_EE_ORIGIN_ZEROCOPY && err.ee_errno == 0) {
+                    return zero_copy_completion{err.ee_info, err.ee_data, (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0};
+                }
+            }
+
+            // Some other error report; look for the next one.
+        }
+    }
+
+    void socket::wait_readable() {
+        wait(POLLIN);
+    }
+
+    void socket::wait_writable() {
+        wait(POLLOUT);
+    }
+
+    int socket::set_zero_copy(bool value) {
+        return set_option(SOL_SOCKET, SO_ZEROCOPY, static_cast<int>(value));
+    }
+
+    int socket::set_non_blocking(bool value) {
+        const auto flags = ::fcntl(fd_, F_GETFL);
+        if (flags < 0) {
+            return flags;
+        }
+        return ::fcntl(fd_, F_SETFL, value ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+    }
+
+    void socket::wait_error_queue() {
+        wait(0); // Errors and hangups are reported regardless of the events.
+    }
+
+    void socket::wait(short events) {
+        ::pollfd fd{.fd = fd_, .events = events, .revents = 0};
+        while (::poll(&fd, 1, -1) < 0) {
+            if (errno != EINTR) {
+                throw std::system_error{errno, std::generic_category()};
+            }
+        }
+    }
 
-        return static_cast<std::size_t>(size_sent);
+    void socket::shutdown(shutdown_type how) noexcept {
+        ::shutdown(fd_, static_cast<int>(how));
     }
 } // namespace mio::sockets
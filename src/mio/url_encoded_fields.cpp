@@ -0,0 +1,73 @@
+#include "mio/url_encoded_fields.hpp"
+
+#include "mio/uri.hpp"
+
+namespace mio {
+    request_result<void> url_encoded_fields::parse(std::string_view source) {
+        if (!parsed_) {
+            parse_fields(source);
+            parsed_ = true;
+        }
+
+        if (malformed_) {
+            return util::unexpected{request_error::bad_request};
+        }
+        return {};
+    }
+
+    void url_encoded_fields::parse_fields(std::string_view source) {
+        const auto decode = [&](std::string_view s) -> std::optional<std::string_view> {
+            if (detail::find_uri_escape(s, true) == s.size()) {
+                return s;
+            }
+
+            if (decoded_.empty() && decoded_.capacity() < source.size()) {
+                // Decoded text is never longer than the source: no reallocation after this.
+                decoded_.reserve(source.size());
+            }
+
+            const auto begin = decoded_.size();
+            decoded_.resize(begin + s.size());
+
+            const auto decoded = decode_uri(s, true, decoded_.data() + begin);
+            if (!decoded) {
+                decoded_.resize(begin);
+                return std::nullopt;
+            }
+
+            decoded_.resize(begin + decoded->size());
+            return *decoded;
+        };
+
+        fields_.clear();
+        decoded_.clear();
+
+        std::size_t pos = 0;
+        while (pos <= source.size()) {
+            auto amp = source.find('&', pos);
+            if (amp == std::string_view::npos) {
+                amp = source.size();
+            }
+
+            const auto expr = source.substr(pos, amp - pos);
+            pos = amp + 1;
+
+            if (expr.empty()) {
+                continue;
+            }
+
+            const auto sep = expr.find('=');
+            const auto key = expr.substr(0, sep);
+            const auto value = sep != std::string_view::npos ? expr.substr(sep + 1) : std::string_view{};
+
+            const auto decoded_key = decode(key);
+            const auto decoded_value = decoded_key ? decode(value) : std::nullopt;
+            if (!decoded_value) {
+                malformed_ = true;
+                continue;
+            }
+
+            fields_.push_back(url_encoded_field{*decoded_key, *decoded_value});
+        }
+    }
+} // namespace mio
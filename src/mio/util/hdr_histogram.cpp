@@ -0,0 +1,102 @@
+#include "mio/util/hdr_histogram.hpp"
+
+#include <cassert>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace mio::util {
+    namespace {
+        constexpr std::uint64_t half_count = hdr_histogram::sub_bucket_count / 2;
+    } // namespace
+
+    // Values below sub_bucket_count map to themselves. Above that, each power of two is split into half_count
+    // buckets: a value with `shift` bits more than sub_bucket_bits lands at shift * half_count + (value >> shift),
+    // where (value >> shift) is in [half_count, sub_bucket_count), so the indices of consecutive ranges abut.
+    std::size_t hdr_histogram::index_of(std::uint64_t value) noexcept {
+        if (value < sub_bucket_count) {
+            return static_cast<std::size_t>(value);
+        }
+
+        const auto shift = static_cast<std::uint64_t>(std::bit_width(value)) - sub_bucket_bits;
+        return static_cast<std::size_t>(shift * half_count + (value >> shift));
+    }
+
+    std::uint64_t hdr_histogram::lowest_equivalent(std::size_t index) noexcept {
+        if (index < sub_bucket_count) {
+            return index;
+        }
+
+        const auto shift = index / half_count - 1;
+        return (index - shift * half_count) << shift;
+    }
+
+    std::uint64_t hdr_histogram::highest_equivalent(std::size_t index) noexcept {
+        if (index < sub_bucket_count) {
+            return index;
+        }
+
+        const auto shift = index / half_count - 1;
+        return lowest_equivalent(index) + (std::uint64_t{1} << shift) - 1;
+    }
+
+    hdr_histogram::hdr_histogram(std::uint64_t highest_value)
+        : highest_value_(std::max(highest_value, sub_bucket_count))
+        , counts_(index_of(highest_value_) + 1)
+        , total_(0)
+        , min_(std::numeric_limits<std::uint64_t>::max())
+        , max_(0)
+        , sum_(0) {
+    }
+
+    void hdr_histogram::record(std::uint64_t value, std::uint64_t count) noexcept {
+        value = std::min(value, highest_value_);
+
+        counts_[index_of(value)] += count;
+        total_ += count;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        sum_ += static_cast<double>(value) * static_cast<double>(count);
+    }
+
+    void hdr_histogram::merge(const hdr_histogram& other) noexcept {
+        assert(other.counts_.size() <= counts_.size());
+
+        for (std::size_t i = 0; i < other.counts_.size(); i++) {
+            counts_[i] += other.counts_[i];
+        }
+
+        total_ += other.total_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        sum_ += other.sum_;
+    }
+
+    void hdr_histogram::reset() noexcept {
+        std::ranges::fill(counts_, 0);
+        total_ = 0;
+        min_ = std::numeric_limits<std::uint64_t>::max();
+        max_ = 0;
+        sum_ = 0;
+    }
+
+    std::uint64_t hdr_histogram::percentile(double percentile) const noexcept {
+        if (total_ == 0) {
+            return 0;
+        }
+
+        // The rank of the value, counting from 1. Rounded to nearest, since 99.9% of 1000 is not quite 999 in floating point.
+        const auto rank = std::clamp(static_cast<std::uint64_t>(std::llround(percentile / 100.0 * static_cast<double>(total_))), std::uint64_t{1}, total_);
+
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); i++) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(highest_equivalent(i), max_);
+            }
+        }
+
+        return max_;
+    }
+} // namespace mio::util
@@ -0,0 +1,30 @@
+#include "mio/util/temporary_file.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <system_error>
+
+#include <fcntl.h>
+
+namespace mio::util {
+    unique_fd open_temporary_file(const std::string& directory) {
+        if (const auto fd = ::open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600); fd >= 0) {
+            return unique_fd{fd};
+        }
+
+        // Not every file system supports O_TMPFILE; name a file and unlink it right away instead.
+        if (errno != EOPNOTSUPP && errno != EISDIR) {
+            throw std::system_error{errno, std::generic_category()};
+        }
+
+        std::string path = directory + "/mio-XXXXXX";
+
+        unique_fd fd{::mkostemp(path.data(), O_CLOEXEC)};
+        if (!fd) {
+            throw std::system_error{errno, std::generic_category()};
+        }
+
+        ::unlink(path.c_str());
+        return fd;
+    }
+} // namespace mio::util
@@ -0,0 +1,135 @@
+#include "mio/util/timer_wheel.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+namespace mio::util {
+    timer_wheel::timer_wheel(clock::duration resolution, clock::time_point now) noexcept
+        : resolution_(resolution)
+        , origin_(now) {
+        assert(resolution > clock::duration::zero());
+    }
+
+    timer_wheel::~timer_wheel() noexcept {
+        for (auto& level : slots_) {
+            for (auto& head : level) {
+                while (head) {
+                    unlink(*head);
+                }
+            }
+        }
+    }
+
+    void timer_wheel::schedule(timer& t, clock::time_point deadline) noexcept {
+        if (t.is_scheduled()) {
+            unlink(t);
+        } else {
+            size_++;
+        }
+
+        const auto ticks = to_ticks(deadline, true);
+        t.expiry_ = std::clamp(ticks, now_ + 1, now_ + max_ticks - 1);
+        place(t);
+    }
+
+    void timer_wheel::cancel(timer& t) noexcept {
+        if (t.is_scheduled()) {
+            unlink(t);
+            size_--;
+        }
+    }
+
+    std::size_t timer_wheel::advance(clock::time_point now) {
+        const auto target = to_ticks(now, false);
+        std::size_t fired = 0;
+
+        while (now_ < target) {
+            if (size_ == 0) {
+                now_ = target;
+                break;
+            }
+
+            now_++;
+
+            const auto index = static_cast<std::size_t>(now_ & (slots_per_level - 1));
+            if (index == 0) {
+                // Bring the timers of the next coarser slot down, and of the level above it if that one wrapped too.
+                for (std::size_t level = 1; level < levels; level++) {
+                    const auto level_index = static_cast<std::size_t>((now_ >> (level_bits * level)) & (slots_per_level - 1));
+                    cascade(level, level_index);
+
+                    if (level_index != 0) {
+                        break;
+                    }
+                }
+            }
+
+            // Callbacks may schedule or cancel timers, but anything they schedule lands on a later tick.
+            while (timer* t = slots_[0][index]) {
+                unlink(*t);
+                size_--;
+                fired++;
+
+                t->callback_();
+            }
+        }
+
+        return fired;
+    }
+
+    std::uint64_t timer_wheel::to_ticks(clock::time_point time, bool round_up) const noexcept {
+        if (time <= origin_) {
+            return 0;
+        }
+
+        const auto elapsed = time - origin_;
+        const auto ticks = static_cast<std::uint64_t>(elapsed / resolution_);
+        return round_up && elapsed % resolution_ != clock::duration::zero() ? ticks + 1 : ticks;
+    }
+
+    void timer_wheel::place(timer& t) noexcept {
+        const auto delta = t.expiry_ - now_;
+
+        std::size_t level = 0;
+        while (level + 1 < levels && delta >= (std::uint64_t{1} << (level_bits * (level + 1)))) {
+            level++;
+        }
+
+        const auto index = static_cast<std::size_t>((t.expiry_ >> (level_bits * level)) & (slots_per_level - 1));
+        link(slots_[level][index], t);
+    }
+
+    void timer_wheel::cascade(std::size_t level, std::size_t index) noexcept {
+        timer* head = slots_[level][index];
+        slots_[level][index] = nullptr;
+
+        while (head) {
+            timer& t = *head;
+            head = t.next_;
+
+            t.next_ = nullptr;
+            t.pprev_ = nullptr;
+            place(t);
+        }
+    }
+
+    void timer_wheel::link(timer*& head, timer& t) noexcept {
+        t.next_ = head;
+        if (head) {
+            head->pprev_ = &t.next_;
+        }
+
+        head = &t;
+        t.pprev_ = &head;
+    }
+
+    void timer_wheel::unlink(timer& t) noexcept {
+        *t.pprev_ = t.next_;
+        if (t.next_) {
+            t.next_->pprev_ = t.pprev_;
+        }
+
+        t.next_ = nullptr;
+        t.pprev_ = nullptr;
+    }
+} // namespace mio::util
@@ -0,0 +1,153 @@
+#include "allocation_counter.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions of the whole executable, so this file lives in its own test binary.
+
+namespace mio::test {
+    namespace {
+        thread_local allocation_counts counts{};
+
+        // Every block starts with a header that records the stage that allocated it, so that its deallocation can be
+        // counted against the same stage. The header is as large as the block's alignment to keep the block aligned.
+        constexpr std::size_t header_size = alignof(std::max_align_t);
+        constexpr unsigned char uncounted = 0xff;
+
+        std::size_t header_size_for(std::size_t align) noexcept {
+            return align > header_size ? align : header_size;
+        }
+
+        // The stage lives in the byte right before the block, wherever the header starts.
+        unsigned char& stage_of(void* p) noexcept {
+            return static_cast<unsigned char*>(p)[-1];
+        }
+
+        unsigned char count(std::size_t size) noexcept {
+            const auto stage = current_request_stage();
+            if (stage == request_stage::idle) {
+                return uncounted;
+            }
+
+            auto& c = counts.stages[static_cast<std::size_t>(stage)];
+            c.allocations++;
+            c.bytes += size;
+            return static_cast<unsigned char>(stage);
+        }
+
+        void* allocate(std::size_t size, std::size_t align) {
+            const auto header = header_size_for(align);
+
+            // aligned_alloc() wants the size to be a multiple of the alignment.
+            const auto total = (header + size + align - 1) / align * align;
+            if (auto* raw = static_cast<unsigned char*>(std::aligned_alloc(align, total))) {
+                void* p = raw + header;
+                stage_of(p) = count(size);
+                return p;
+            }
+            throw std::bad_alloc{};
+        }
+
+        void* allocate(std::size_t size) {
+            return allocate(size, header_size);
+        }
+
+        void* allocate(std::size_t size, std::align_val_t alignment) {
+            return allocate(size, static_cast<std::size_t>(alignment));
+        }
+
+        void deallocate(void* p, std::size_t align = header_size) noexcept {
+            if (p == nullptr) {
+                return;
+            }
+
+            if (const auto stage = stage_of(p); stage != uncounted) {
+                counts.stages[stage].deallocations++;
+            }
+            std::free(static_cast<unsigned char*>(p) - header_size_for(align));
+        }
+    } // namespace
+
+    allocation_count allocation_counts::total() const noexcept {
+        allocation_count sum{};
+        for (const auto& c : stages) {
+            sum.allocations += c.allocations;
+            sum.bytes += c.bytes;
+            sum.deallocations += c.deallocations;
+        }
+        return sum;
+    }
+
+    allocation_counts thread_allocation_counts() noexcept {
+        return counts;
+    }
+
+    void reset_thread_allocation_counts() noexcept {
+        counts = {};
+    }
+} // namespace mio::test
+
+void* operator new(std::size_t size) {
+    return mio::test::allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return mio::test::allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return mio::test::allocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return mio::test::allocate(size, alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return mio::test::allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return mio::test::allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept {
+    mio::test::deallocate(p);
+}
+
+void operator delete[](void* p) noexcept {
+    mio::test::deallocate(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    mio::test::deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    mio::test::deallocate(p);
+}
+
+void operator delete(void* p, std::align_val_t alignment) noexcept {
+    mio::test::deallocate(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept {
+    mio::test::deallocate(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept {
+    mio::test::deallocate(p, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept {
+    mio::test::deallocate(p, static_cast<std::size_t>(alignment));
+}
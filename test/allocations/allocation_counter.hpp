@@ -0,0 +1,34 @@
+#ifndef INCLUDE_test_allocations_allocation_counter_hpp
+#define INCLUDE_test_allocations_allocation_counter_hpp
+
+#include <array>
+#include <cstdint>
+
+#include "mio/request_stage.hpp"
+
+namespace mio::test {
+    struct allocation_count {
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+        // How many of the allocations have been freed again on this thread, whatever stage it was in by then.
+        std::uint64_t deallocations;
+    };
+
+    // What this thread has allocated through operator new, by the request stage it was in, and how much of it it has
+    // freed. Allocations outside of requests, such as the test's own, are not counted.
+    struct allocation_counts {
+        std::array<allocation_count, request_stage_count> stages;
+
+        [[nodiscard]] const allocation_count& operator[](request_stage stage) const noexcept {
+            return stages[static_cast<std::size_t>(stage)];
+        }
+
+        [[nodiscard]] allocation_count total() const noexcept;
+    };
+
+    [[nodiscard]] allocation_counts thread_allocation_counts() noexcept;
+
+    void reset_thread_allocation_counts() noexcept;
+} // namespace mio::test
+
+#endif // INCLUDE_test_allocations_allocation_counter_hpp
@@ -0,0 +1,169 @@
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "mio/application.hpp"
+#include "mio/http_request.hpp"
+#include "mio/http_response.hpp"
+#include "mio/http_server.hpp"
+#include "mio/sockets/socket.hpp"
+
+#include "allocation_counter.hpp"
+
+// Counts what a request allocates in each stage of the in-process pipeline, and holds each scenario to a budget so
+// that a change that adds allocations to a hot path fails here instead of going unnoticed.
+
+namespace {
+    // Requests per measured connection. Their responses must fit in the socket buffer, since nothing reads them until
+    // the connection is done.
+    constexpr std::size_t batch_size = 32;
+
+    constexpr std::string_view stage_names[] = {"idle", "parse", "headers", "routing", "body", "handler", "serialize"};
+    static_assert(std::size(stage_names) == mio::request_stage_count);
+
+    class application : public mio::application_base {
+    public:
+        application() {
+            get_router().get("/hello", [](const mio::http_request&) { return mio::http_response{200, "hello"}; });
+            get_router().get("/users/:id", [](mio::http_request& req) { return mio::http_response{200, std::string{req.param("id").value_or("")}}; });
+            get_router().post("/users", [](mio::http_request& req) { return mio::http_response{201, std::string{req.form("name").value_or("")}}; });
+        }
+    };
+
+    // Serves `requests` copies of `request` over one connection on this thread and returns what they allocated.
+    mio::test::allocation_counts serve(mio::http_server& server, std::string_view request, std::size_t requests) {
+        std::string input{};
+        for (std::size_t i = 0; i < requests; i++) {
+            input += request;
+        }
+
+        auto [client, server_end] = mio::sockets::socket::pair();
+
+        client.send(input.data(), input.size());
+        client.shutdown(mio::sockets::shutdown_type::send);
+
+        mio::test::reset_thread_allocation_counts();
+        server.serve(std::move(server_end));
+        const auto counts = mio::test::thread_allocation_counts();
+
+        char buffer[64 * 1024];
+        while (client.receive(buffer, sizeof(buffer)) > 0) {
+        }
+
+        return counts;
+    }
+
+    // What `batch_size` requests allocate once the connection is warm: a batch against a single request, which also
+    // pays for filling the arena.
+    mio::test::allocation_counts per_batch(mio::http_server& server, std::string_view request) {
+        const auto one = serve(server, request, 1);
+        const auto batch = serve(server, request, batch_size + 1);
+
+        mio::test::allocation_counts counts{};
+        for (std::size_t i = 0; i < mio::request_stage_count; i++) {
+            counts.stages[i].allocations = batch.stages[i].allocations - one.stages[i].allocations;
+            counts.stages[i].bytes = batch.stages[i].bytes - one.stages[i].bytes;
+            counts.stages[i].deallocations = batch.stages[i].deallocations - one.stages[i].deallocations;
+        }
+        return counts;
+    }
+
+    void print(std::string_view name, const mio::test::allocation_count& count) {
+        std::printf("  %-10.*s %6.2f allocs/req %8.1f bytes/req\n", static_cast<int>(name.size()), name.data(),
+                    static_cast<double>(count.allocations) / batch_size, static_cast<double>(count.bytes) / batch_size);
+    }
+
+    void print(std::string_view name, const mio::test::allocation_counts& counts) {
+        std::printf("%.*s\n", static_cast<int>(name.size()), name.data());
+        for (std::size_t i = 1; i < mio::request_stage_count; i++) {
+            print(stage_names[i], counts.stages[i]);
+        }
+        print("total", counts.total());
+    }
+
+    struct budget {
+        double parse;
+        double headers;
+        double routing;
+        double body;
+        double handler;
+        double serialize;
+    };
+
+    // Allocations per request allowed in each stage, in the order parse, headers, routing, body, handler, serialize. A
+    // stage that allocates now and then, such as when a buffer grows, averages below one. Whatever a stage allocates must
+    // also be freed by the time the connection closes, or the requests leak.
+    void check(std::string_view name, mio::http_server& server, std::string_view request, const budget& b) {
+        const auto counts = per_batch(server, request);
+        print(name, counts);
+
+        const auto within = [&](mio::request_stage stage, double allowed) {
+            return static_cast<double>(counts[stage].allocations) <= allowed * batch_size;
+        };
+
+        assert(within(mio::request_stage::idle, 0));
+        assert(within(mio::request_stage::parse, b.parse));
+        assert(within(mio::request_stage::headers, b.headers));
+        assert(within(mio::request_stage::routing, b.routing));
+        assert(within(mio::request_stage::body, b.body));
+        assert(within(mio::request_stage::handler, b.handler));
+        assert(within(mio::request_stage::serialize, b.serialize));
+
+        for (const auto& c : counts.stages) {
+            assert(c.deallocations == c.allocations);
+        }
+    }
+} // namespace
+
+int main() {
+    mio::http_server server{std::make_unique<application>()};
+
+    check("static route, 10 headers", server,
+          "GET /hello HTTP/1.1\r\n"
+          "Host: api.example.com\r\n"
+          "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/115.0\r\n"
+          "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+          "Accept-Language: en-US,en;q=0.5\r\n"
+          "Accept-Encoding: gzip, deflate, br\r\n"
+          "Cache-Control: no-cache\r\n"
+          "Pragma: no-cache\r\n"
+          "Referer: https://example.com/\r\n"
+          "Cookie: session=5f2b1c0e9d8a7b6c5d4e3f2a1b0c9d8e; theme=dark\r\n"
+          "Connection: keep-alive\r\n"
+          "\r\n",
+          {0, 0, 0, 0, 1, 0.5});
+
+    check("parameter route", server,
+          "GET /users/1234 HTTP/1.1\r\n"
+          "host: localhost\r\n"
+          "connection: keep-alive\r\n"
+          "\r\n",
+          {0, 0, 0, 0, 1, 0.5});
+
+    // The parameter is decoded on the stack; only the request keeps a copy, in the arena.
+    check("escaped parameter", server,
+          "GET /users/mio%20user HTTP/1.1\r\n"
+          "host: localhost\r\n"
+          "connection: keep-alive\r\n"
+          "\r\n",
+          {0, 0, 0, 0, 1, 0.5});
+
+    check("form post", server,
+          "POST /users HTTP/1.1\r\n"
+          "host: localhost\r\n"
+          "connection: keep-alive\r\n"
+          "content-type: application/x-www-form-urlencoded\r\n"
+          "content-length: 22\r\n"
+          "\r\n"
+          "name=mio&email=a%40b.c",
+          {0, 0, 0, 0, 1, 0.5});
+
+    // The lookup allocates nothing; the default 404 page is built on the heap by the handler stage.
+    check("not found", server,
+          "GET /missing HTTP/1.1\r\n"
+          "host: localhost\r\n"
+          "connection: keep-alive\r\n"
+          "\r\n",
+          {0, 0, 0, 0, 6, 0.5});
+}
@@ -0,0 +1,212 @@
+#include "mio/bodies/multipart.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <optional>
+
+#include "mio/http_request.hpp"
+#include "mio/request_error.hpp"
+
+namespace {
+    const std::string_view body =
+        "preamble\r\n"
+        "--XyZ\r\n"
+        "Content-Disposition: form-data; name=\"title\"\r\n"
+        "\r\n"
+        "Hello, --XyZ world\r\n"
+        "--XyZ  \r\n"
+        "Content-Disposition: form-data; name=\"upload\"; filename=\"a;b.txt\"\r\n"
+        "Content-Type: text/plain\r\n"
+        "\r\n"
+        "line 1\r\n"
+        "line 2\r\n-XyZ--\r\n"
+        "\r\n"
+        "--XyZ\r\n"
+        "Content-Disposition: form-data; name=\"empty\"\r\n"
+        "\r\n"
+        "\r\n"
+        "--XyZ--\r\n"
+        "epilogue";
+
+    const std::string_view file_content = "line 1\r\nline 2\r\n-XyZ--\r\n";
+
+    std::string read_file(const std::filesystem::path& path) {
+        std::ifstream ifs{path, std::ios::binary};
+        return std::string(std::istreambuf_iterator<char>{ifs}, std::istreambuf_iterator<char>{});
+    }
+
+    void test_boundary() {
+        mio::http_headers headers{};
+        headers.set("Content-Type", "multipart/form-data; boundary=\"XyZ\"; charset=utf-8");
+        assert(mio::bodies::multipart_boundary(headers) == "XyZ");
+
+        headers.set("Content-Type", "Multipart/Form-Data; boundary=----abc");
+        assert(mio::bodies::multipart_boundary(headers) == "----abc");
+
+        headers.set("Content-Type", "application/x-www-form-urlencoded");
+        assert(mio::bodies::multipart_boundary(headers) == std::nullopt);
+    }
+
+    void test_parser_chunks() {
+        // Every chunk size must give the same result, including those splitting delimiters.
+        for (std::size_t chunk = 1; chunk <= body.size(); chunk++) {
+            std::filesystem::path path{};
+            {
+                mio::bodies::multipart_form form{};
+                mio::bodies::multipart_parser parser{"XyZ", form};
+
+                for (std::size_t pos = 0; pos < body.size(); pos += chunk) {
+                    parser.feed(body.substr(pos, chunk));
+                }
+
+                assert(parser.done());
+                assert(form.fields().size() == 2);
+                assert(form.field("title") == "Hello, --XyZ world");
+                assert(form.field("empty") == "");
+
+                const auto file = form.file("upload");
+                assert(file != nullptr);
+                assert(file->filename() == "a;b.txt");
+                assert(file->content_type() == "text/plain");
+                assert(file->size() == file_content.size());
+                assert(read_file(file->path()) == file_content);
+
+                path = file->path();
+            }
+
+            // Unpersisted files are removed with the form.
+            assert(!std::filesystem::exists(path));
+        }
+    }
+
+    void test_sink() {
+        std::string received{};
+
+        mio::bodies::multipart_options options{};
+        options.open_file = [&](const mio::bodies::multipart_part& part) -> mio::bodies::multipart_sink {
+            assert(part.name == "upload");
+            assert(part.filename == "a;b.txt");
+            return [&](std::span<const std::byte> data) {
+                received.append(reinterpret_cast<const char*>(data.data()), data.size());
+            };
+        };
+
+        mio::http_headers headers{};
+        headers.set("Content-Type", "multipart/form-data; boundary=XyZ");
+
+        const auto bytes = std::as_bytes(std::span{body});
+        mio::http_request req{"POST", "/", "HTTP/1.1", std::move(headers), std::pmr::vector<std::byte>(std::begin(bytes), std::end(bytes))};
+
+        auto form = mio::bodies::parse_multipart(req, std::move(options));
+        assert(form.field("title") == "Hello, --XyZ world");
+        assert(form.files().empty());
+        assert(received == file_content);
+    }
+
+    // Streams a body a few bytes at a time, as a slow connection would.
+    class trickle_reader : public mio::body_reader {
+    public:
+        explicit trickle_reader(std::string_view data)
+            : data_(data) {
+        }
+
+        std::size_t read_some(std::span<std::byte> buffer) override {
+            const auto n = std::min({buffer.size(), data_.size(), std::size_t{7}});
+            std::memcpy(buffer.data(), data_.data(), n);
+            data_.remove_prefix(n);
+            return n;
+        }
+
+    private:
+        std::string_view data_;
+    };
+
+    void test_streamed_body() {
+        mio::http_headers headers{};
+        headers.set("Content-Type", "multipart/form-data; boundary=XyZ");
+
+        trickle_reader reader{body};
+
+        mio::http_request req{"POST", "/", "HTTP/1.1", std::move(headers)};
+        req.set_body_reader(&reader);
+        assert(req.is_body_streamed());
+
+        auto form = mio::bodies::parse_multipart(req);
+        assert(form.field("title") == "Hello, --XyZ world");
+        assert(form.file("upload") != nullptr);
+        assert(read_file(form.file("upload")->path()) == file_content);
+
+        std::byte buffer[16];
+        assert(req.read_some(buffer) == 0);
+    }
+
+    void test_invalid() {
+        const auto error = [](std::string_view input, std::size_t max_field_size = 1024) {
+            mio::bodies::multipart_options options{};
+            options.max_field_size = max_field_size;
+
+            mio::bodies::multipart_form form{std::move(options)};
+            mio::bodies::multipart_parser parser{"XyZ", form};
+            try {
+                parser.feed(input);
+            } catch (const mio::request_error_exception& e) {
+                return std::optional{e.error()};
+            }
+            return std::optional<mio::request_error>{};
+        };
+
+        assert(error("--XyZ\r\nContent-Disposition\r\n\r\n") == mio::request_error::bad_request);
+        assert(error("--XyZ?\r\n") == mio::request_error::bad_request);
+        assert(error("--XyZ\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n") == mio::request_error::bad_request);
+        assert(error("--XyZ\r\nContent-Disposition: form-data; name=\"a\"\r\n\r\n0123456789\r\n--XyZ--", 4) == mio::request_error::payload_too_large);
+        assert(!error("--XyZ\r\nContent-Disposition: form-data; name=\"a\"\r\n\r\n0123\r\n--XyZ--", 4));
+    }
+
+    void test_limits() {
+        const auto error = [](std::size_t fields, std::size_t files, std::size_t field_size, const mio::bodies::multipart_options& options) {
+            std::string input{};
+            for (std::size_t i = 0; i < fields; i++) {
+                input += "--XyZ\r\nContent-Disposition: form-data; name=\"a\"\r\n\r\n" + std::string(field_size, 'x') + "\r\n";
+            }
+            for (std::size_t i = 0; i < files; i++) {
+                input += "--XyZ\r\nContent-Disposition: form-data; name=\"f\"; filename=\"f.txt\"\r\n\r\ncontent\r\n";
+            }
+            input += "--XyZ--";
+
+            mio::bodies::multipart_form form{options};
+            mio::bodies::multipart_parser parser{"XyZ", form};
+            try {
+                parser.feed(input);
+            } catch (const mio::request_error_exception& e) {
+                return std::optional{e.error()};
+            }
+            return std::optional<mio::request_error>{};
+        };
+
+        mio::bodies::multipart_options options{};
+        options.max_fields = 3;
+        options.max_total_field_size = 10;
+        options.max_files = 2;
+
+        assert(!error(3, 2, 3, options));
+        assert(error(4, 0, 0, options) == mio::request_error::payload_too_large);
+        assert(error(0, 3, 0, options) == mio::request_error::payload_too_large);
+        assert(error(3, 0, 4, options) == mio::request_error::payload_too_large); // 12 bytes of fields in all.
+
+        // Files given to a sink count as well.
+        options.open_file = [](const mio::bodies::multipart_part&) { return mio::bodies::multipart_sink{}; };
+        assert(error(0, 3, 0, options) == mio::request_error::payload_too_large);
+    }
+} // namespace
+
+void test_multipart() {
+    test_boundary();
+    test_parser_chunks();
+    test_sink();
+    test_streamed_body();
+    test_invalid();
+    test_limits();
+}
@@ -0,0 +1,114 @@
+#include "mio/http1/chunked.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    // Feeds `input` in pieces of `step` bytes and returns the decoded body.
+    std::string decode(std::string_view input, std::size_t step, mio::http1::parse_result& result, std::size_t& rest) {
+        mio::http1::chunked_decoder decoder{};
+        std::string body{};
+
+        result = mio::http1::parse_result::in_progress;
+        rest = 0;
+
+        for (std::size_t pos = 0; pos < input.size() && result == mio::http1::parse_result::in_progress;) {
+            const auto n = std::min(step, input.size() - pos);
+            std::vector<std::byte> buffer(n);
+            std::memcpy(buffer.data(), input.data() + pos, n);
+
+            std::size_t size;
+            std::size_t consumed;
+            result = decoder.decode(buffer, size, consumed);
+
+            body.append(reinterpret_cast<const char*>(buffer.data()), size);
+            pos += consumed;
+            rest = input.size() - pos;
+        }
+
+        assert((result == mio::http1::parse_result::completed) == decoder.done());
+        return body;
+    }
+
+    void test_chunked_decoder() {
+        constexpr std::string_view input =
+            "5\r\n"
+            "Hello\r\n"
+            "1;name=value\r\n"
+            ",\r\n"
+            "1A\r\n"
+            " abcdefghijklmnopqrstuvwxy\r\n"
+            "0\r\n"
+            "expires: never\r\n"
+            "\r\n"
+            "GET / HTTP/1.1\r\n";
+
+        for (const std::size_t step : {1, 2, 3, 7, 64, 1024}) {
+            mio::http1::parse_result result;
+            std::size_t rest;
+            const auto body = decode(input, step, result, rest);
+
+            assert(result == mio::http1::parse_result::completed);
+            assert(body == "Hello, abcdefghijklmnopqrstuvwxy");
+            assert(rest == std::string_view{"GET / HTTP/1.1\r\n"}.size());
+        }
+    }
+
+    void test_chunked_decoder_in_progress() {
+        mio::http1::parse_result result;
+        std::size_t rest;
+        const auto body = decode("4\r\nabcd\r\n3\r\nef", 5, result, rest);
+
+        assert(result == mio::http1::parse_result::in_progress);
+        assert(body == "abcdef");
+        assert(rest == 0);
+    }
+
+    void test_chunked_decoder_invalid() {
+        for (const std::string_view input : {
+                 "\r\n",
+                 "x\r\n",
+                 "4\nabcd\r\n",
+                 "4\r\nabcde\r\n",
+                 "1000000000000000\r\n",
+                 "0\r\n\r\r",
+             }) {
+            mio::http1::parse_result result;
+            std::size_t rest;
+            decode(input, 1, result, rest);
+
+            assert(result == mio::http1::parse_result::invalid);
+        }
+    }
+
+    void test_chunk_writer() {
+        std::pmr::string out{};
+
+        mio::http1::write_chunk(out, std::as_bytes(std::span{std::string_view{"Hello"}}));
+        mio::http1::write_chunk(out, {});
+        mio::http1::write_chunk(out, std::as_bytes(std::span{std::string_view{"0123456789abcdefghij"}}));
+        mio::http1::write_last_chunk(out);
+
+        assert(out ==
+               "5\r\n"
+               "Hello\r\n"
+               "14\r\n"
+               "0123456789abcdefghij\r\n"
+               "0\r\n"
+               "\r\n");
+
+        mio::http1::parse_result result;
+        std::size_t rest;
+        assert(decode(out, 4, result, rest) == "Hello0123456789abcdefghij");
+        assert(result == mio::http1::parse_result::completed);
+    }
+} // namespace
+
+void test_chunked() {
+    test_chunked_decoder();
+    test_chunked_decoder_in_progress();
+    test_chunked_decoder_invalid();
+    test_chunk_writer();
+}
@@ -0,0 +1,58 @@
+#include "mio/http1/date.hpp"
+
+#include <cassert>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::string_view as_view(const auto& chars) {
+        return std::string_view{chars.data(), chars.size()};
+    }
+
+    void test_format_date() {
+        assert(as_view(mio::http1::format_date(784111777)) == "Sun, 06 Nov 1994 08:49:37 GMT");
+        assert(as_view(mio::http1::format_date(0)) == "Thu, 01 Jan 1970 00:00:00 GMT");
+        assert(as_view(mio::http1::format_date(951782400)) == "Tue, 29 Feb 2000 00:00:00 GMT");
+    }
+
+    void test_date_header() {
+        mio::http1::date_header date{784111777};
+        assert(as_view(date.get()) == "date: Sun, 06 Nov 1994 08:49:37 GMT\r\n");
+
+        date.update(784111777 + 1);
+        assert(as_view(date.get()) == "date: Sun, 06 Nov 1994 08:49:38 GMT\r\n");
+    }
+
+    void test_date_header_concurrent() {
+        mio::http1::date_header date{0};
+
+        // Readers never see a line torn between two updates.
+        std::vector<std::jthread> readers{};
+        for (int i = 0; i < 4; i++) {
+            readers.emplace_back([&date](std::stop_token stop) {
+                while (!stop.stop_requested()) {
+                    const auto line = date.get();
+                    const auto minutes = (line[26] - '0') * 10 + (line[27] - '0');
+                    const auto seconds = (line[29] - '0') * 10 + (line[30] - '0');
+                    const auto expected = mio::http1::format_date(static_cast<std::time_t>(minutes * 60 + seconds));
+                    assert(as_view(line).substr(6, mio::http1::date_size) == as_view(expected));
+                }
+            });
+        }
+
+        for (std::time_t minute = 0; minute < 60; minute++) {
+            for (int i = 0; i < 100; i++) {
+                date.update(minute * 60);
+                date.update(minute * 60 + 1);
+                date.update(minute * 60);
+            }
+        }
+    }
+} // namespace
+
+void test_date() {
+    test_format_date();
+    test_date_header();
+    test_date_header_concurrent();
+}
@@ -56,6 +56,18 @@ namespace {
 
             assert(result == mio::http1::parse_result::too_many_headers);
         }
+        {
+            // Other versions are parsed so that they can be refused with 505.
+            mio::http1::request req;
+            mio::http1::header buffer[1];
+
+            std::size_t header_size;
+            assert(mio::http1::parse_request(req, buffer, "GET / HTTP/2.0\r\n\r\n", header_size) == mio::http1::parse_result::completed);
+            assert(req.http_version == "HTTP/2.0");
+
+            assert(mio::http1::parse_request(req, buffer, "GET / HTTP/.1\r\n\r\n", header_size) == mio::http1::parse_result::invalid);
+            assert(mio::http1::parse_request(req, buffer, "GET / HTTP/1\r\n\r\n", header_size) == mio::http1::parse_result::invalid);
+        }
     }
 } // namespace
 
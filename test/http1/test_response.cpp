@@ -8,6 +8,14 @@ namespace {
         assert(mio::http1::status_code_string(200) == "OK");
         assert(mio::http1::status_code_string(201) == "Created");
         assert(mio::http1::status_code_string(404) == "Not Found");
+        assert(mio::http1::status_code_string(511) == "Network Authentication Required");
+        assert(mio::http1::status_code_string(299) == "Unknown");
+        assert(mio::http1::status_code_string(99) == "Unknown");
+        assert(mio::http1::status_code_string(600) == "Unknown");
+
+        static_assert(mio::http1::status_line(200) == "HTTP/1.1 200 OK\r\n");
+        static_assert(mio::http1::status_line(418) == "HTTP/1.1 418 I'm a teapot\r\n");
+        static_assert(mio::http1::status_line(299).empty());
     }
 
     void test_response_writer() {
@@ -36,9 +44,50 @@ namespace {
                "\r\n"
                "<p>Hello</p>");
     }
+
+    void test_chunked_response_writer() {
+        mio::http1::response res{};
+        res.http_version = "HTTP/1.1";
+        res.status_code = 200;
+        res.chunked = true;
+
+        mio::http1::header headers[] = {
+            {"content-type", "text/plain"},
+        };
+
+        res.headers = headers;
+
+        std::pmr::string out{};
+        mio::http1::write_response(out, res);
+
+        assert(out ==
+               "HTTP/1.1 200 OK\r\n"
+               "content-type: text/plain\r\n"
+               "transfer-encoding: chunked\r\n"
+               "\r\n");
+    }
+
+    void test_response_head_status_line() {
+        mio::http1::response res{};
+        res.http_version = "HTTP/1.0";
+        res.status_code = 404;
+
+        std::pmr::string out{};
+        mio::http1::write_response_head(out, res);
+        assert(out.starts_with("HTTP/1.0 404 Not Found\r\n"));
+
+        res.http_version = "HTTP/1.1";
+        res.status_code = 299;
+
+        out.clear();
+        mio::http1::write_response_head(out, res);
+        assert(out.starts_with("HTTP/1.1 299 Unknown\r\n"));
+    }
 } // namespace
 
 void test_response() {
     test_status_code();
     test_response_writer();
+    test_chunked_response_writer();
+    test_response_head_status_line();
 }
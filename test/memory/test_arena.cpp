@@ -0,0 +1,84 @@
+#include "mio/memory/arena.hpp"
+
+#include <cassert>
+
+#include "mio/http_request.hpp"
+#include "mio/http_response.hpp"
+
+namespace {
+    // Counts allocations reaching the upstream of an arena.
+    class counting_resource : public std::pmr::memory_resource {
+    public:
+        std::size_t count = 0;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            count++;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    void test_resource_scope() {
+        assert(mio::memory::current_resource() == std::pmr::get_default_resource());
+
+        mio::memory::arena arena{};
+        {
+            const mio::memory::resource_scope scope{arena.resource()};
+            assert(mio::memory::current_resource() == arena.resource());
+
+            // Responses and headers stay on the heap, since a handler may keep them past the request.
+            mio::http_response res{200, "OK"};
+            assert(res.headers().resource() == std::pmr::new_delete_resource());
+
+            mio::http_response on_arena{200, "OK", arena.resource()};
+            assert(on_arena.headers().resource() == arena.resource());
+        }
+
+        assert(mio::memory::current_resource() == std::pmr::get_default_resource());
+    }
+
+    void test_arena_reset() {
+        counting_resource upstream{};
+        const auto previous = std::pmr::set_default_resource(&upstream);
+
+        {
+            mio::memory::arena arena{};
+            const mio::memory::resource_scope scope{arena.resource()};
+
+            for (int i = 0; i < 100; i++) {
+                {
+                    mio::http_headers headers{arena.resource()};
+                    headers.append("Host", "example.com");
+                    headers.append("User-Agent", "mio-test/1.0 (a reasonably long user agent string)");
+                    headers.append("Accept", "*/*");
+
+                    mio::http_request req{"GET", "/index.html?page=1", "HTTP/1.1", std::move(headers)};
+                    req.set_param("id", "a reasonably long parameter value that does not fit SSO");
+
+                    mio::http_response res{200, "<p>Hello</p>", arena.resource()};
+                    res.headers().set("content-type", "text/html; charset=utf-8");
+                }
+
+                arena.reset();
+            }
+        }
+
+        std::pmr::set_default_resource(previous);
+
+        // Every request is served from the arena block; nothing reaches the upstream resource.
+        assert(upstream.count == 0);
+    }
+} // namespace
+
+void test_arena() {
+    test_resource_scope();
+    test_arena_reset();
+}
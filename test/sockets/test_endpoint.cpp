@@ -0,0 +1,88 @@
+#include "mio/sockets/endpoint.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace {
+    void test_endpoint_inet() {
+        const auto v4 = mio::sockets::endpoint::inet("127.0.0.1", 8080);
+        assert(v4.family() == mio::sockets::address_family::inet);
+        assert(v4.port() == 8080);
+        assert(v4.to_string() == "127.0.0.1:8080");
+
+        const auto v6 = mio::sockets::endpoint::inet("::1", 443);
+        assert(v6.family() == mio::sockets::address_family::inet6);
+        assert(v6.port() == 443);
+        assert(v6.to_string() == "[::1]:443");
+
+        const auto any = mio::sockets::endpoint::any(80);
+        assert(any.family() == mio::sockets::address_family::inet6);
+        assert(any.to_string() == "[::]:80");
+        assert(any.is_any());
+
+        const auto any_v4 = mio::sockets::endpoint::any_v4(80);
+        assert(any_v4.family() == mio::sockets::address_family::inet);
+        assert(any_v4.to_string() == "0.0.0.0:80");
+        assert(any_v4.is_any());
+
+        assert(!v4.is_any());
+        assert(!v6.is_any());
+        assert(!mio::sockets::endpoint::local("/run/mio.sock").is_any());
+
+        for (const auto address : {"", "localhost", "127.0.0.256", "::1%", "0123456789012345678901234567890123456789012345678901234567890123"}) {
+            bool thrown = false;
+            try {
+                (void)mio::sockets::endpoint::inet(address, 80);
+            } catch (const std::runtime_error&) {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+    }
+
+    void test_endpoint_local() {
+        const auto path = mio::sockets::endpoint::local("/run/mio.sock");
+        assert(path.family() == mio::sockets::address_family::local);
+        assert(path.port() == 0);
+        assert(path.path() == "/run/mio.sock");
+        assert(path.to_string() == "unix:/run/mio.sock");
+
+        const auto abstract = mio::sockets::endpoint::local("@mio");
+        assert(abstract.path() == "@mio");
+
+        bool thrown = false;
+        try {
+            (void)mio::sockets::endpoint::local(std::string(200, 'a'));
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    void test_endpoint_listen() {
+        {
+            mio::sockets::socket socket{mio::sockets::address_family::inet, mio::sockets::socket_type::stream};
+            socket.listen(mio::sockets::endpoint::inet("127.0.0.1", 0));
+
+            const auto bound = socket.local_endpoint();
+            assert(bound.family() == mio::sockets::address_family::inet);
+            assert(bound.port() != 0);
+        }
+        {
+            const auto name = "@mio-test-" + std::to_string(::getpid());
+
+            mio::sockets::socket socket{mio::sockets::address_family::local, mio::sockets::socket_type::stream};
+            socket.listen(mio::sockets::endpoint::local(name));
+
+            assert(socket.local_endpoint().path() == name);
+        }
+    }
+} // namespace
+
+void test_endpoint() {
+    test_endpoint_inet();
+    test_endpoint_local();
+    test_endpoint_listen();
+}
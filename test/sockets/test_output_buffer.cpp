@@ -0,0 +1,132 @@
+#include "mio/sockets/output_buffer.hpp"
+
+#include <cassert>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+
+#include "mio/sockets/endpoint.hpp"
+
+namespace {
+    struct socket_pair {
+        mio::sockets::socket server;
+        mio::sockets::socket client;
+    };
+
+    socket_pair connect() {
+        mio::sockets::socket listener{mio::sockets::address_family::inet, mio::sockets::socket_type::stream};
+        listener.listen(mio::sockets::endpoint::inet("127.0.0.1", 0));
+
+        const auto address = listener.local_endpoint();
+
+        mio::sockets::socket client{mio::sockets::address_family::inet, mio::sockets::socket_type::stream};
+        const int result = ::connect(client.descriptor(), address.data(), address.size());
+        assert(result == 0);
+
+        mio::sockets::endpoint peer{};
+        auto server = listener.accept(peer);
+        assert(server);
+
+        return socket_pair{std::move(*server), std::move(client)};
+    }
+
+    std::string receive_all(mio::sockets::socket& socket, std::size_t size) {
+        std::string received(size, '\0');
+        for (std::size_t n = 0; n < size;) {
+            const auto m = socket.receive(received.data() + n, size - n);
+            assert(m > 0);
+            n += m;
+        }
+        return received;
+    }
+
+    void test_output_buffer_coalesce() {
+        auto [server, client] = connect();
+        mio::sockets::output_buffer out{server};
+
+        const std::string large(4096, 'L');
+
+        out.write("HTTP/1.1 200 OK\r\n");
+        out.write("\r\n");
+        out.write_ref(std::as_bytes(std::span{large}));
+        out.write_ref(std::as_bytes(std::span{std::string_view{"small"}})); // Copied.
+        assert(out.size() == 19 + large.size() + 5);
+
+        out.flush();
+        assert(out.empty());
+
+        assert(receive_all(client, 19 + large.size() + 5) == "HTTP/1.1 200 OK\r\n\r\n" + large + "small");
+    }
+
+    void test_output_buffer_partial_writes() {
+        auto [server, client] = connect();
+        server.set_send_buffer_size(4096);
+        client.set_receive_buffer_size(4096);
+
+        std::string expected{};
+        for (int i = 0; i < 2000; i++) {
+            expected += std::to_string(i) + ",";
+        }
+        const std::string large(1024 * 1024, 'z');
+        expected += large;
+
+        mio::sockets::output_buffer out{server};
+        for (int i = 0; i < 2000; i++) {
+            out.write(std::to_string(i) + ",");
+        }
+        out.write_ref(std::as_bytes(std::span{large}));
+
+        // Nobody reads yet, so the socket fills up and the rest stays queued.
+        assert(!out.try_flush());
+        assert(!out.empty() && out.size() < expected.size());
+
+        std::string received{};
+        std::thread reader{[&, &client = client] { received = receive_all(client, expected.size()); }};
+
+        out.flush();
+        reader.join();
+
+        assert(out.empty());
+        assert(received == expected);
+    }
+
+    void test_output_buffer_zero_copy() {
+        auto [server, client] = connect();
+
+        mio::sockets::output_buffer out{server};
+        if (!out.enable_zero_copy(64 * 1024)) {
+            return; // Not supported by the kernel.
+        }
+
+        const std::string small(1000, 's');
+        const std::string large(1024 * 1024, 'Z');
+
+        out.write("head");
+        out.write_zero_copy(std::as_bytes(std::span{small})); // Below the threshold.
+        out.write_zero_copy(std::as_bytes(std::span{large}));
+        out.write("tail");
+
+        std::string received{};
+        std::thread reader{[&, &client = client] { received = receive_all(client, 4 + small.size() + large.size() + 4); }};
+
+        out.flush();
+        reader.join();
+
+        assert(received == "head" + small + large + "tail");
+
+        while (!out.reap_zero_copy()) {
+            server.wait_error_queue();
+        }
+        assert(!out.zero_copy_pending());
+
+        // Loopback copies the data in the end, which turns zero copy off.
+        assert(!out.zero_copy_enabled());
+    }
+} // namespace
+
+void test_output_buffer() {
+    test_output_buffer_coalesce();
+    test_output_buffer_partial_writes();
+    test_output_buffer_zero_copy();
+}
@@ -0,0 +1,48 @@
+#include "mio/sockets/socket.hpp"
+
+#include <cassert>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include "mio/sockets/endpoint.hpp"
+
+namespace {
+    void test_socket_accept() {
+        mio::sockets::socket listener{mio::sockets::address_family::inet, mio::sockets::socket_type::stream};
+        listener.listen(mio::sockets::endpoint::inet("127.0.0.1", 0));
+        listener.set_non_blocking(true);
+
+        mio::sockets::endpoint peer{};
+        assert(!listener.accept(peer));
+
+        const auto address = listener.local_endpoint();
+
+        mio::sockets::socket client{mio::sockets::address_family::inet, mio::sockets::socket_type::stream};
+        assert(::connect(client.descriptor(), address.data(), address.size()) == 0);
+
+        auto accepted = listener.accept(peer);
+        assert(accepted);
+        assert(peer.family() == mio::sockets::address_family::inet);
+        assert(peer.to_string().starts_with("127.0.0.1:"));
+        assert(peer.port() == client.local_endpoint().port());
+
+        // Accepted sockets are non-blocking and close-on-exec; receive() waits for data regardless.
+        assert(::fcntl(accepted->descriptor(), F_GETFL) & O_NONBLOCK);
+        assert(::fcntl(accepted->descriptor(), F_GETFD) & FD_CLOEXEC);
+
+        constexpr std::string_view message = "hello";
+        assert(client.send(message.data(), message.size()) == message.size());
+
+        char buffer[16];
+        assert(accepted->receive(buffer, sizeof(buffer)) == message.size());
+        assert(std::string_view(buffer, message.size()) == message);
+
+        assert(!listener.accept(peer));
+    }
+} // namespace
+
+void test_socket() {
+    test_socket_accept();
+}
@@ -1,13 +1,43 @@
 void test_request();
+void test_chunked();
+void test_date();
 void test_response();
 void test_uri();
 void test_http_headers();
+void test_http_server();
+void test_metrics();
 void test_router();
+void test_application();
+void test_prebuilt_response();
+void test_arena();
+void test_url_encoded_fields();
+void test_multipart();
+void test_timer_wheel();
+void test_hdr_histogram();
+void test_temporary_file();
+void test_endpoint();
+void test_socket();
+void test_output_buffer();
 
 int main() {
     test_request();
+    test_chunked();
+    test_date();
     test_response();
     test_uri();
     test_http_headers();
     test_router();
+    test_application();
+    test_prebuilt_response();
+    test_arena();
+    test_url_encoded_fields();
+    test_multipart();
+    test_timer_wheel();
+    test_hdr_histogram();
+    test_temporary_file();
+    test_endpoint();
+    test_socket();
+    test_output_buffer();
+    test_metrics();
+    test_http_server();
 }
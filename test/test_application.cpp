@@ -0,0 +1,206 @@
+#include "mio/application.hpp"
+
+#include <cassert>
+
+#include "mio/http_request.hpp"
+#include "mio/http_response.hpp"
+#include "mio/pipeline.hpp"
+
+namespace {
+    class application : public mio::application_base {
+    public:
+        application() {
+            get_router().get("/", [](const mio::http_request&) { return mio::http_response{200, "/"}; });
+            get_router().get("/api/items", [](const mio::http_request&) { return mio::http_response{200, "items"}; });
+            get_router().get("/api/items/:id", [](const mio::http_request&) { return mio::http_response{200, "item"}; });
+        }
+    };
+
+    mio::http_response request(mio::application& app, std::string_view path) {
+        mio::http_request req{"GET", path, "HTTP/1.1", mio::http_headers{}};
+        return app.on_request(req);
+    }
+
+    void test_middlewares() {
+        application app{};
+        std::string trace{};
+
+        app.around([&](mio::http_request& req, const mio::next_handler& next) {
+            trace += "(";
+            auto res = next(req);
+            trace += ")";
+            return res;
+        });
+
+        app.before("/api", [&](mio::http_request& req) -> std::optional<mio::http_response> {
+            trace += "auth ";
+            if (!req.headers().get("authorization")) {
+                return mio::http_response{401, "unauthorized"};
+            }
+            return std::nullopt;
+        });
+
+        app.before([&](mio::http_request&) -> std::optional<mio::http_response> {
+            trace += "before ";
+            return std::nullopt;
+        });
+
+        app.after([&](mio::http_request&, mio::http_response& res) {
+            trace += "after ";
+            res.headers().set("x-after", "1");
+        });
+
+        app.around("/api/", [&](mio::http_request& req, const mio::next_handler& next) {
+            trace += "[";
+            auto res = next(req);
+            trace += "]";
+            return res;
+        });
+
+        {
+            trace.clear();
+            const auto res = request(app, "/");
+            assert(res.status_code() == 200);
+            assert(res.body_as_text() == "/");
+            assert(res.headers().get("x-after") == "1");
+            assert(trace == "(before after )");
+        }
+        {
+            trace.clear();
+            const auto res = request(app, "/api/items");
+            assert(res.status_code() == 401);
+            assert(res.headers().get("x-after") == "1");
+            assert(trace == "([auth after ])");
+        }
+        {
+            trace.clear();
+            const auto res = request(app, "/apix");
+            assert(res.status_code() == 404);
+            assert(trace == "(before after )");
+        }
+    }
+
+    void test_around_short_circuit() {
+        application app{};
+        bool reached = false;
+
+        app.around([](mio::http_request&, const mio::next_handler&) {
+            return mio::http_response{503, "unavailable"};
+        });
+
+        app.before([&](mio::http_request&) -> std::optional<mio::http_response> {
+            reached = true;
+            return std::nullopt;
+        });
+
+        const auto res = request(app, "/");
+        assert(res.status_code() == 503);
+        assert(!reached);
+    }
+
+    void test_pipeline() {
+        std::string trace{};
+
+        auto handler = mio::make_pipeline(
+            [&](mio::http_request&) {
+                trace += "handler ";
+                return mio::http_response{200, "OK"};
+            },
+            [&](mio::http_request& req, auto&& next) {
+                trace += "(";
+                auto res = next(req);
+                trace += ")";
+                return res;
+            },
+            mio::layers::scoped("/admin", mio::layers::before([&](mio::http_request&) -> std::optional<mio::http_response> {
+                trace += "deny ";
+                return mio::http_response{403, "forbidden"};
+            })),
+            mio::layers::after([&](mio::http_request&, mio::http_response& res) {
+                trace += "after ";
+                res.headers().set("x-after", "1");
+            }));
+
+        {
+            trace.clear();
+            mio::http_request req{"GET", "/items", "HTTP/1.1", mio::http_headers{}};
+            const auto res = handler(req);
+            assert(res.status_code() == 200);
+            assert(res.headers().get("x-after") == "1");
+            assert(trace == "(handler after )");
+        }
+        {
+            trace.clear();
+            mio::http_request req{"GET", "/admin/users", "HTTP/1.1", mio::http_headers{}};
+            const auto res = handler(req);
+            assert(res.status_code() == 403);
+            assert(!res.headers().get("x-after"));
+            assert(trace == "(deny )");
+        }
+
+        mio::router router{};
+        router.get("/", std::move(handler));
+    }
+
+    void test_before_body() {
+        application app{};
+        app.get_router().post("/upload", [](const mio::http_request&) { return mio::http_response{200, "uploaded"}; }, {.stream_body = true, .max_body_size = 1024});
+
+        app.before_body("/upload", [](mio::http_request& req) -> std::optional<mio::http_response> {
+            if (!req.headers().get("authorization")) {
+                return mio::http_response{401, "unauthorized"};
+            }
+            return std::nullopt;
+        });
+
+        {
+            mio::http_request req{"POST", "/upload", "HTTP/1.1", mio::http_headers{}};
+            mio::route_options options{};
+            const auto res = app.on_headers(req, options);
+
+            assert(res && res->status_code() == 401);
+        }
+        {
+            mio::http_request req{"POST", "/upload", "HTTP/1.1", mio::http_headers{{"authorization", "token"}}};
+            mio::route_options options{};
+
+            assert(!app.on_headers(req, options));
+            assert(options.stream_body);
+            assert(options.max_body_size == 1024);
+        }
+        {
+            mio::http_request req{"GET", "/", "HTTP/1.1", mio::http_headers{}};
+            mio::route_options options{};
+
+            assert(!app.on_headers(req, options));
+            assert(options == mio::route_options{});
+        }
+        {
+            mio::http_request req{"GET", "/api/items/%zz", "HTTP/1.1", mio::http_headers{}};
+            mio::route_options options{};
+            const auto res = app.on_headers(req, options);
+
+            assert(res && res->status_code() == 400);
+        }
+    }
+
+    void test_request_error() {
+        application app{};
+
+        assert(request(app, "/api/items/%zz").status_code() == 400);
+        assert(request(app, "/api/items/1").body_as_text() == "item");
+
+        assert(app.on_request_error(mio::request_error::bad_request).status_code() == 400);
+        assert(app.on_request_error(mio::request_error::payload_too_large).status_code() == 413);
+        assert(app.on_request_error(mio::request_error::header_fields_too_large).status_code() == 431);
+        assert(app.on_request_error(mio::request_error::http_version_not_supported).status_code() == 505);
+    }
+} // namespace
+
+void test_application() {
+    test_middlewares();
+    test_around_short_circuit();
+    test_pipeline();
+    test_before_body();
+    test_request_error();
+}
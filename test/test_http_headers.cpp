@@ -1,6 +1,7 @@
 #include "mio/http_headers.hpp"
 
 #include <cassert>
+#include <string_view>
 
 void test_http_headers() {
     mio::http_headers headers{
@@ -48,4 +49,14 @@ void test_http_headers() {
     assert(headers.entries()[2].value == "Mio");
     assert(headers.entries()[3].key == "vary");
     assert(headers.entries()[3].value == "*");
+
+    // A content-length is all digits.
+    for (const std::string_view value : {"", "3abc", "3 ", " 3", "+3", "-3", "3,3", "0x10", "99999999999999999999999"}) {
+        mio::http_headers invalid{};
+        assert(!invalid.try_append("content-length", value));
+    }
+
+    mio::http_headers zero{};
+    assert(zero.try_append("content-length", "0"));
+    assert(zero.content_length() == 0);
 }
@@ -0,0 +1,260 @@
+#include "mio/http_server.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "mio/application.hpp"
+#include "mio/bodies/multipart.hpp"
+#include "mio/prebuilt_response.hpp"
+#include "mio/sockets/socket.hpp"
+
+namespace {
+    class application : public mio::application_base {
+    public:
+        application() {
+            get_router().get("/hello", [](const mio::http_request&) { return mio::http_response{200, "hello"}; });
+            get_router().post("/upload", [](mio::http_request& req) {
+                mio::bodies::multipart_options options{};
+                options.max_field_size = 4;
+
+                const auto form = mio::bodies::parse_multipart(req, std::move(options));
+                return mio::http_response{200, "title=" + std::string{form.field("title").value_or("")}};
+            });
+            get_router().get("/prebuilt", mio::prebuilt(mio::http_response::json(200, R"({"status":"ok"})")));
+            get_router().get("/throw", [](const mio::http_request&) -> mio::http_response { throw std::runtime_error{"secret"}; });
+            get_router().post("/form", [](mio::http_request& req) { return mio::http_response{200, "name=" + std::string{req.form("name").value_or("")}}; });
+        }
+    };
+
+    // Sends `input` and ends the stream, serves the connection on this thread, and returns everything sent back.
+    std::string exchange(mio::http_server& server, std::string_view input) {
+        auto [client, server_end] = mio::sockets::socket::pair();
+
+        client.send(input.data(), input.size());
+        client.shutdown(mio::sockets::shutdown_type::send);
+
+        server.serve(std::move(server_end));
+
+        std::string output{};
+        char buffer[4096];
+        while (const auto n = client.receive(buffer, sizeof(buffer))) {
+            output.append(buffer, n);
+        }
+        return output;
+    }
+
+    std::size_t count(std::string_view s, std::string_view pattern) {
+        std::size_t n = 0;
+        for (auto pos = s.find(pattern); pos != std::string_view::npos; pos = s.find(pattern, pos + 1)) {
+            n++;
+        }
+        return n;
+    }
+
+    void test_http_server_pipeline() {
+        mio::http_server server{std::make_unique<application>()};
+
+        const auto output = exchange(server,
+                                     "GET /hello HTTP/1.1\r\n"
+                                     "connection: keep-alive\r\n"
+                                     "\r\n"
+                                     "GET /missing HTTP/1.1\r\n"
+                                     "connection: keep-alive\r\n"
+                                     "\r\n"
+                                     "POST /form HTTP/1.1\r\n"
+                                     "connection: keep-alive\r\n"
+                                     "content-type: application/x-www-form-urlencoded\r\n"
+                                     "content-length: 10\r\n"
+                                     "\r\n"
+                                     "name=a%20b");
+
+        // Every pipelined request is answered in order; the end of the stream closes the connection.
+        assert(count(output, "HTTP/1.1 ") == 3);
+        assert(output.starts_with("HTTP/1.1 200 OK\r\n"));
+        assert(output.find("HTTP/1.1 404 Not Found\r\n") < output.rfind("HTTP/1.1 200 OK\r\n"));
+        assert(count(output, "date: ") == 3);
+        assert(output.find("\r\n\r\nhello") != std::string::npos);
+        assert(output.ends_with("\r\n\r\nname=a b"));
+    }
+
+    void test_http_server_prebuilt() {
+        mio::http_server server{std::make_unique<application>()};
+
+        // The same body follows the Connection header of either kind of connection.
+        const auto output = exchange(server,
+                                     "GET /prebuilt HTTP/1.1\r\n"
+                                     "connection: keep-alive\r\n"
+                                     "\r\n"
+                                     "GET /prebuilt HTTP/1.1\r\n"
+                                     "\r\n");
+
+        assert(count(output, "HTTP/1.1 200 OK\r\n") == 2);
+        assert(count(output, "date: ") == 2);
+        assert(count(output, "\r\nconnection: keep-alive\r\n\r\n{\"status\":\"ok\"}") == 1);
+        assert(output.ends_with("\r\nconnection: close\r\n\r\n{\"status\":\"ok\"}"));
+    }
+
+    void test_http_server_malformed() {
+        mio::http_server server{std::make_unique<application>()};
+
+        // A malformed request is answered and closes the connection; what follows it is not read.
+        const auto output = exchange(server,
+                                     "GET /hello HTTP/1.1 x\r\n"
+                                     "\r\n"
+                                     "GET /hello HTTP/1.1\r\n"
+                                     "\r\n");
+
+        assert(count(output, "HTTP/1.1 ") == 1);
+        assert(output.starts_with("HTTP/1.1 400 Bad Request\r\n"));
+        assert(output.find("connection: close\r\n") != std::string::npos);
+
+        assert(exchange(server, "GET /hello HTTP/2.0\r\n\r\n").starts_with("HTTP/1.1 505 HTTP Version Not Supported\r\n"));
+
+        // A content-length with anything after its digits would leave part of the body to be read as a request.
+        const auto smuggled = exchange(server,
+                                       "POST /form HTTP/1.1\r\n"
+                                       "content-type: application/x-www-form-urlencoded\r\n"
+                                       "content-length: 3abc\r\n"
+                                       "\r\n"
+                                       "abcGET /hello HTTP/1.1\r\n"
+                                       "\r\n");
+
+        assert(count(smuggled, "HTTP/1.1 ") == 1);
+        assert(smuggled.starts_with("HTTP/1.1 400 Bad Request\r\n"));
+
+        // What a handler throws is a server error, and its message stays private.
+        const auto thrown = exchange(server, "GET /throw HTTP/1.1\r\n\r\n");
+        assert(thrown.starts_with("HTTP/1.1 500 Internal Server Error\r\n"));
+        assert(thrown.find("secret") == std::string::npos);
+    }
+
+    void test_http_server_bad_chunked() {
+        mio::http_server_options options{};
+        options.max_body_size = 8;
+
+        mio::http_server server{std::make_unique<application>(), options};
+
+        // A body that cannot be framed is refused, and the connection closes before the request after it.
+        const auto output = exchange(server,
+                                     "POST /form HTTP/1.1\r\n"
+                                     "transfer-encoding: chunked\r\n"
+                                     "\r\n"
+                                     "zz\r\n"
+                                     "GET /hello HTTP/1.1\r\n"
+                                     "\r\n");
+
+        assert(count(output, "HTTP/1.1 ") == 1);
+        assert(output.starts_with("HTTP/1.1 400 Bad Request\r\n"));
+        assert(output.find("connection: close\r\n") != std::string::npos);
+
+        const auto too_large = exchange(server,
+                                        "POST /form HTTP/1.1\r\n"
+                                        "transfer-encoding: chunked\r\n"
+                                        "\r\n"
+                                        "10\r\n"
+                                        "0123456789abcdef\r\n"
+                                        "0\r\n"
+                                        "\r\n");
+
+        assert(too_large.starts_with("HTTP/1.1 413 Request Entity Too Large\r\n"));
+        assert(too_large.find("connection: close\r\n") != std::string::npos);
+    }
+
+    void test_http_server_bad_multipart() {
+        mio::http_server server{std::make_unique<application>()};
+
+        const auto post = [&](std::string_view body) {
+            const auto request = "POST /upload HTTP/1.1\r\n"
+                                 "content-type: multipart/form-data; boundary=XyZ\r\n"
+                                 "content-length: " +
+                                 std::to_string(body.size()) + "\r\n\r\n" + std::string{body};
+            return exchange(server, request.c_str());
+        };
+
+        assert(post("--XyZ\r\nContent-Disposition: form-data; name=\"title\"\r\n\r\nmio\r\n--XyZ--\r\n").ends_with("\r\n\r\ntitle=mio"));
+
+        // Errors in a body parsed by a handler are request errors too.
+        const auto malformed = post("--XyZ?\r\n");
+        assert(malformed.starts_with("HTTP/1.1 400 Bad Request\r\n"));
+        assert(malformed.find("connection: close\r\n") != std::string::npos);
+
+        const auto too_large = post("--XyZ\r\nContent-Disposition: form-data; name=\"title\"\r\n\r\n0123456789\r\n--XyZ--\r\n");
+        assert(too_large.starts_with("HTTP/1.1 413 Request Entity Too Large\r\n"));
+    }
+
+    void test_http_server_timeout() {
+        mio::http_server_options options{};
+        options.header_timeout = std::chrono::milliseconds{200};
+
+        mio::http_server server{std::make_unique<application>(), options};
+
+        // The second request never ends; it is cut off by the header timeout, well before the idle one.
+        auto [client, server_end] = mio::sockets::socket::pair();
+
+        const std::string_view input =
+            "GET /hello HTTP/1.1\r\n"
+            "connection: keep-alive\r\n"
+            "\r\n"
+            "GET /hello HTTP/1.1\r\n";
+        client.send(input.data(), input.size());
+
+        const auto start = std::chrono::steady_clock::now();
+        server.serve(std::move(server_end));
+        assert(std::chrono::steady_clock::now() - start < std::chrono::seconds{5});
+
+        std::string output{};
+        char buffer[4096];
+        while (const auto n = client.receive(buffer, sizeof(buffer))) {
+            output.append(buffer, n);
+        }
+
+        assert(output.starts_with("HTTP/1.1 200 OK\r\n"));
+        assert(output.find("HTTP/1.1 408 Request Timeout\r\n") != std::string::npos);
+    }
+
+    void test_http_server_metrics() {
+        mio::http_server_options options{};
+        options.metrics_path = "/metrics";
+
+        mio::http_server server{std::make_unique<application>(), options};
+        assert(server.get_metrics() != nullptr);
+
+        static_cast<void>(exchange(server,
+                                   "GET /hello HTTP/1.1\r\n"
+                                   "connection: keep-alive\r\n"
+                                   "\r\n"
+                                   "GET /missing HTTP/1.1\r\n"
+                                   "\r\n"));
+        static_cast<void>(exchange(server, "GET /hello HTTP/1.1 x\r\n\r\n"));
+
+        const auto output = exchange(server, "GET /metrics HTTP/1.1\r\n\r\n");
+
+        assert(output.starts_with("HTTP/1.1 200 OK\r\n"));
+        assert(output.find("content-type: text/plain; version=0.0.4; charset=utf-8\r\n") != std::string::npos);
+        assert(output.find("mio_http_requests_total{route=\"/hello\",method=\"GET\",status=\"200\"} 1\n") != std::string::npos);
+        assert(output.find("mio_http_requests_total{route=\"\",method=\"GET\",status=\"404\"} 1\n") != std::string::npos);
+        assert(output.find("mio_http_requests_total{route=\"\",method=\"OTHER\",status=\"400\"} 1\n") != std::string::npos);
+        assert(output.find("mio_http_request_duration_seconds_count{route=\"/hello\",method=\"GET\"} 1\n") != std::string::npos);
+        assert(output.find("mio_http_request_errors_total{error=\"bad_request\"} 1\n") != std::string::npos);
+        assert(output.find("mio_http_active_connections 1\n") != std::string::npos); // The scrape's own connection.
+        assert(output.find("mio_http_received_bytes_total 0\n") == std::string::npos);
+
+        // Without a metrics path, the path is the application's.
+        mio::http_server plain{std::make_unique<application>()};
+        assert(plain.get_metrics() == nullptr);
+        assert(exchange(plain, "GET /metrics HTTP/1.1\r\n\r\n").starts_with("HTTP/1.1 404 Not Found\r\n"));
+    }
+} // namespace
+
+void test_http_server() {
+    test_http_server_pipeline();
+    test_http_server_prebuilt();
+    test_http_server_malformed();
+    test_http_server_bad_chunked();
+    test_http_server_bad_multipart();
+    test_http_server_timeout();
+    test_http_server_metrics();
+}
@@ -0,0 +1,167 @@
+#include "mio/metrics.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "mio/router.hpp"
+
+namespace {
+    using namespace std::chrono_literals;
+
+    bool contains(std::string_view text, std::string_view line) {
+        return text.find(line) != std::string_view::npos;
+    }
+
+    void test_metrics_requests() {
+        mio::metrics m{4};
+
+        const mio::route users{{}, {}, "/users/:id"};
+        const auto get = mio::metrics::method_index("GET");
+
+        m.record_request(&users, get, 200, 1ms);
+        m.record_request(&users, get, 200, 1500us);
+        m.record_request(&users, get, 404, 2ms);
+        m.record_request(&users, mio::metrics::method_index("POST"), 201, 1ms);
+        m.record_request(nullptr, mio::metrics::method_index("BREW"), 404, 1ms);
+
+        std::string text{};
+        m.write_prometheus(text);
+
+        assert(contains(text, "# TYPE mio_http_requests_total counter\n"));
+        assert(contains(text, "mio_http_requests_total{route=\"/users/:id\",method=\"GET\",status=\"200\"} 2\n"));
+        assert(contains(text, "mio_http_requests_total{route=\"/users/:id\",method=\"GET\",status=\"404\"} 1\n"));
+        assert(contains(text, "mio_http_requests_total{route=\"/users/:id\",method=\"POST\",status=\"201\"} 1\n"));
+        assert(contains(text, "mio_http_requests_total{route=\"\",method=\"OTHER\",status=\"404\"} 1\n"));
+
+        // Buckets are cumulative, and a latency equal to a bound falls in its bucket.
+        assert(contains(text, "# TYPE mio_http_request_duration_seconds histogram\n"));
+        assert(contains(text, "mio_http_request_duration_seconds_bucket{route=\"/users/:id\",method=\"GET\",le=\"0.0005\"} 0\n"));
+        assert(contains(text, "mio_http_request_duration_seconds_bucket{route=\"/users/:id\",method=\"GET\",le=\"0.001\"} 1\n"));
+        assert(contains(text, "mio_http_request_duration_seconds_bucket{route=\"/users/:id\",method=\"GET\",le=\"0.0025\"} 3\n"));
+        assert(contains(text, "mio_http_request_duration_seconds_bucket{route=\"/users/:id\",method=\"GET\",le=\"+Inf\"} 3\n"));
+        assert(contains(text, "mio_http_request_duration_seconds_sum{route=\"/users/:id\",method=\"GET\"} 0.0045\n"));
+        assert(contains(text, "mio_http_request_duration_seconds_count{route=\"/users/:id\",method=\"GET\"} 3\n"));
+    }
+
+    void test_metrics_statuses() {
+        mio::metrics m{1};
+
+        const mio::route hello{{}, {}, "/hello"};
+        const auto get = mio::metrics::method_index("GET");
+
+        // One status more than a series counts apart.
+        for (std::size_t i = 0; i <= mio::metrics::max_statuses; i++) {
+            m.record_request(&hello, get, 200 + static_cast<std::int32_t>(i), 1ms);
+        }
+        m.record_request(&hello, get, 200, 20s);
+
+        std::string text{};
+        m.write_prometheus(text);
+
+        assert(contains(text, "mio_http_requests_total{route=\"/hello\",method=\"GET\",status=\"200\"} 2\n"));
+        assert(contains(text, "mio_http_requests_total{route=\"/hello\",method=\"GET\",status=\"207\"} 1\n"));
+        assert(!contains(text, "status=\"208\""));
+        assert(contains(text, "mio_http_request_duration_seconds_bucket{route=\"/hello\",method=\"GET\",le=\"10\"} 8\n"));
+        assert(contains(text, "mio_http_request_duration_seconds_bucket{route=\"/hello\",method=\"GET\",le=\"+Inf\"} 9\n"));
+        assert(contains(text, "mio_metrics_dropped_requests_total 1\n"));
+    }
+
+    void test_metrics_counters() {
+        mio::metrics m{};
+
+        m.connection_opened();
+        m.connection_opened();
+        m.connection_closed();
+        m.record_bytes(100, 250);
+        m.record_bytes(20, 0);
+        m.record_request_error(mio::request_error::bad_request);
+        m.record_request_error(mio::request_error::header_fields_too_large);
+        m.record_request_error(mio::request_error::bad_request);
+
+        std::string text{};
+        m.write_prometheus(text);
+
+        assert(contains(text, "mio_http_active_connections 1\n"));
+        assert(contains(text, "mio_http_received_bytes_total 120\n"));
+        assert(contains(text, "mio_http_sent_bytes_total 250\n"));
+        assert(contains(text, "mio_http_request_errors_total{error=\"bad_request\"} 2\n"));
+        assert(contains(text, "mio_http_request_errors_total{error=\"header_fields_too_large\"} 1\n"));
+        assert(contains(text, "mio_http_request_errors_total{error=\"payload_too_large\"} 0\n"));
+    }
+
+    void test_metrics_threads() {
+        mio::metrics m{2};
+
+        const mio::route hello{{}, {}, "/hello \"world\"\\"};
+        const auto get = mio::metrics::method_index("GET");
+
+        // More threads than shards, so that some share one.
+        std::vector<std::thread> threads{};
+        for (int i = 0; i < 8; i++) {
+            threads.emplace_back([&] {
+                for (int n = 0; n < 1000; n++) {
+                    m.record_request(&hello, get, 200, 10us);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        std::string text{};
+        m.write_prometheus(text);
+
+        // Shards are merged into one series, whose labels are escaped.
+        assert(contains(text, "mio_http_requests_total{route=\"/hello \\\"world\\\"\\\\\",method=\"GET\",status=\"200\"} 8000\n"));
+        assert(contains(text, "mio_http_request_duration_seconds_count{route=\"/hello \\\"world\\\"\\\\\",method=\"GET\"} 8000\n"));
+    }
+    void test_metrics_recorders() {
+        mio::metrics m{1};
+
+        const mio::route hello{{}, {}, "/hello"};
+        const auto get = mio::metrics::method_index("GET");
+
+        {
+            // Two shards are there to be claimed; the third recorder shares one.
+            mio::metrics::recorder a{m};
+            mio::metrics::recorder b{m};
+            mio::metrics::recorder c{m};
+            assert(a.is_exclusive());
+            assert(b.is_exclusive());
+            assert(!c.is_exclusive());
+
+            a.record_request(&hello, get, 200, 10us);
+            b.record_request(&hello, get, 200, 10us);
+            c.record_request(&hello, get, 200, 10us);
+            a.record_bytes(10, 20);
+            c.record_bytes(1, 2);
+        }
+
+        // A released shard is claimed again, and keeps what it had.
+        mio::metrics::recorder d{m};
+        assert(d.is_exclusive());
+        d.record_request(&hello, get, 500, 10us);
+        d.record_request_error(mio::request_error::payload_too_large);
+
+        std::string text{};
+        m.write_prometheus(text);
+
+        assert(contains(text, "mio_http_requests_total{route=\"/hello\",method=\"GET\",status=\"200\"} 3\n"));
+        assert(contains(text, "mio_http_requests_total{route=\"/hello\",method=\"GET\",status=\"500\"} 1\n"));
+        assert(contains(text, "mio_http_received_bytes_total 11\n"));
+        assert(contains(text, "mio_http_sent_bytes_total 22\n"));
+        assert(contains(text, "mio_http_request_errors_total{error=\"payload_too_large\"} 1\n"));
+    }
+} // namespace
+
+void test_metrics() {
+    test_metrics_requests();
+    test_metrics_statuses();
+    test_metrics_counters();
+    test_metrics_threads();
+    test_metrics_recorders();
+}
@@ -0,0 +1,45 @@
+#include "mio/prebuilt_response.hpp"
+
+#include <cassert>
+#include <string>
+
+#include "mio/http_request.hpp"
+#include "mio/http_response.hpp"
+
+namespace {
+    std::string_view as_text(std::span<const std::byte> bytes) {
+        return std::string_view{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    }
+
+    void test_prebuilt_response_wire() {
+        mio::http_response res{200, mio::http_headers{{"content-type", "text/plain"}, {"connection", "close"}, {"date", "Sun, 06 Nov 1994 08:49:37 GMT"}}, "ok"};
+        const mio::prebuilt_response prebuilt{res};
+
+        assert(prebuilt.status_code() == 200);
+        assert(as_text(prebuilt.head()) == "HTTP/1.1 200 OK\r\ncontent-type: text/plain\r\ncontent-length: 2\r\n");
+        assert(mio::prebuilt_response::connection_line(true) == "connection: keep-alive\r\n\r\n");
+        assert(mio::prebuilt_response::connection_line(false) == "connection: close\r\n\r\n");
+        assert(as_text(prebuilt.body()) == "ok");
+    }
+
+    void test_prebuilt_response_handler() {
+        const auto handler = mio::prebuilt(mio::http_response::json(404, R"({"error":"not found"})"));
+
+        mio::http_request req{"GET", "/", "HTTP/1.1", mio::http_headers{}};
+        const auto a = handler(req);
+        const auto b = handler(req);
+
+        assert(a.status_code() == 404);
+        assert(a.prebuilt() != nullptr);
+        assert(a.prebuilt() == b.prebuilt()); // Shared, not rebuilt.
+        assert(a.body().empty());
+        assert(as_text(a.prebuilt()->body()) == R"({"error":"not found"})");
+
+        assert(mio::http_response{200}.prebuilt() == nullptr);
+    }
+} // namespace
+
+void test_prebuilt_response() {
+    test_prebuilt_response_wire();
+    test_prebuilt_response_handler();
+}
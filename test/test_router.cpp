@@ -8,12 +8,13 @@
 #include "mio/http_response.hpp"
 
 namespace {
-    void test_tree(const mio::routing_tree& tree, const std::string& path, const std::string& method, std::initializer_list<std::pair<std::string_view, std::string>> expected_params, std::string_view expected_body) {
+    void test_tree(const mio::routing_tree& tree, const std::string& path, const std::string& method, std::initializer_list<std::pair<std::string_view, std::string_view>> expected_params, std::string_view expected_body) {
         mio::http_headers headers{};
         mio::http_request req{method, path, "HTTP/1.1", std::move(headers)};
-        std::vector<std::pair<std::string_view, std::string>> params{};
+        mio::route_params params{};
+        std::string buffer(path.size(), '\0');
 
-        const auto handler = tree.find(path, req.method(), params);
+        const auto handler = tree.find(path, req.method(), params, buffer.data());
         if (handler == nullptr) {
             std::cerr << method << " " << path << ": not found" << std::endl;
             assert(handler != nullptr);
@@ -32,9 +33,10 @@ namespace {
     }
 
     void test_tree_not_found(const mio::routing_tree& tree, const std::string& path, const std::string& method) {
-        std::vector<std::pair<std::string_view, std::string>> params{};
+        mio::route_params params{};
+        std::string buffer(path.size(), '\0');
 
-        const auto handler = tree.find(path, method, params);
+        const auto handler = tree.find(path, method, params, buffer.data());
         if (handler != nullptr) {
             std::cerr << method << " " << path << ": found" << std::endl;
             assert(handler == nullptr);
@@ -106,7 +108,7 @@ namespace {
         mio::http_headers headers{};
         mio::http_request req{method, path, "HTTP/1.1", std::move(headers)};
 
-        const std::optional<mio::http_response> res = router.handle_request(req);
+        const std::optional<mio::http_response> res = router.handle_request(req).value();
         if (!res) {
             std::cerr << method << " " << path << ": res == nullopt" << std::endl;
             assert(res);
@@ -122,7 +124,7 @@ namespace {
         mio::http_headers headers{};
         mio::http_request req{method, path, "HTTP/1.1", std::move(headers)};
 
-        const std::optional<mio::http_response> res = router.handle_request(req);
+        const std::optional<mio::http_response> res = router.handle_request(req).value();
         if (res) {
             std::cerr << method << " " << path << ": res != nullopt (" << res->body_as_text() << ")" << std::endl;
             assert(!res);
@@ -164,9 +166,96 @@ namespace {
         test_request_not_found(router, "GET", "/foo/bar");
         test_request_not_found(router, "GET", "/xxx/yyy");
     }
+
+    void test_router_mount() {
+        mio::router router{};
+        router.get("/assets/missing", [](const mio::http_request&) { return mio::http_response{200, "GET /assets/missing"}; });
+
+        router.mount("/assets", [](const mio::http_request&, std::string_view path) -> std::optional<mio::http_response> {
+            if (path == "/missing") {
+                return std::nullopt;
+            }
+            return mio::http_response{200, "assets:" + std::string{path}};
+        });
+
+        router.scope("/xxx", [](auto& r) {
+            r.mount("/yyy/", [](const mio::http_request&, std::string_view path) -> std::optional<mio::http_response> {
+                return mio::http_response{200, "yyy:" + std::string{path}};
+            });
+        });
+
+        router.mount("/xxx", [](const mio::http_request&, std::string_view path) -> std::optional<mio::http_response> {
+            return mio::http_response{200, "xxx:" + std::string{path}};
+        });
+
+        // Routes are matched before any mount.
+        router.get("/xxx/yyy/exact", [](const mio::http_request&) { return mio::http_response{200, "GET /xxx/yyy/exact"}; });
+
+        test_request(router, "GET", "/assets/style.css", "assets:/style.css");
+        test_request(router, "GET", "/assets/a/b.js?v=1", "assets:/a/b.js");
+        test_request(router, "POST", "/assets/", "assets:/");
+        test_request(router, "GET", "/assets", "assets:");
+        test_request(router, "GET", "/assets/missing", "GET /assets/missing");
+        test_request(router, "GET", "/xxx/yyy/zzz", "yyy:/zzz");
+        test_request(router, "GET", "/xxx/yyy", "yyy:");
+        test_request(router, "GET", "/xxx/zzz", "xxx:/zzz");
+        test_request(router, "GET", "/xxx/yyy/exact", "GET /xxx/yyy/exact");
+        test_request(router, "POST", "/xxx/yyy/exact", "yyy:/exact");
+
+        test_request_not_found(router, "GET", "/assetsx");
+        test_request_not_found(router, "POST", "/assets/missing");
+    }
+
+    void test_router_options() {
+        mio::router router{};
+        router.get("/", [](const mio::http_request&) { return mio::http_response{200, "GET /"}; });
+        router.scope("/files", [](auto& r) {
+            r.post("/:name", [](const mio::http_request&) { return mio::http_response{200, "POST /files/:name"}; }, {.stream_body = true});
+        });
+
+        const auto options = [&](std::string_view method, std::string_view path) {
+            mio::http_request req{method, path, "HTTP/1.1", mio::http_headers{}};
+            return router.find_options(req).value();
+        };
+
+        assert(!options("GET", "/").stream_body);
+        assert(options("POST", "/files/a.txt").stream_body);
+        assert(!options("GET", "/files/a.txt").stream_body);
+        assert(!options("POST", "/unknown").stream_body);
+
+        test_request(router, "POST", "/files/a.txt", "POST /files/:name");
+    }
+
+    void test_router_invalid() {
+        mio::router router{};
+        router.get("/users/:id", [](const mio::http_request&) { return mio::http_response{200, "GET /users/:id"}; }, {.stream_body = true});
+
+        // A malformed escape in a placeholder is an error rather than a miss, and it is not thrown.
+        mio::http_request req{"GET", "/users/%zz", "HTTP/1.1", mio::http_headers{}};
+
+        const auto res = router.handle_request(req);
+        assert(!res);
+        assert(res.error() == mio::request_error::bad_request);
+
+        const auto options = router.find_options(req);
+        assert(!options);
+        assert(options.error() == mio::request_error::bad_request);
+
+        // Static segments are matched undecoded.
+        test_request_not_found(router, "GET", "/%zz");
+
+        // A mount may still answer what the routes cannot decode.
+        router.mount("/users", [](const mio::http_request&, std::string_view path) -> std::optional<mio::http_response> {
+            return mio::http_response{200, "users:" + std::string{path}};
+        });
+        test_request(router, "GET", "/users/%zz", "users:/%zz");
+    }
 } // namespace
 
 void test_router() {
     test_routing_tree();
     test_router_();
+    test_router_mount();
+    test_router_options();
+    test_router_invalid();
 }
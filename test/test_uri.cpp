@@ -3,6 +3,28 @@
 #include <cassert>
 
 void test_uri() {
-    assert(mio::decode_uri("a%20b") == "a b");
-    assert(mio::decode_uri("%3Fx%3dtest") == "?x=test");
+    assert(mio::decode_uri("a%20b", false) == "a b");
+    assert(mio::decode_uri("%3Fx%3dtest", false) == "?x=test");
+    assert(mio::decode_uri("a+b%2B", true) == "a b+");
+    assert(mio::decode_uri("a+b%2B", false) == "a+b+");
+    assert(mio::decode_uri("a%2", false) == std::nullopt);
+    assert(mio::decode_uri("a%zz", false) == std::nullopt);
+
+    {
+        // Nothing to decode: the input is returned as is.
+        const std::string_view s = "/assets/style.css";
+        char buffer[32];
+
+        const auto decoded = mio::decode_uri(s, true, buffer);
+        assert(decoded == s);
+        assert(decoded->data() == s.data());
+    }
+    {
+        const std::string_view s = "caf%C3%A9+au+lait";
+        char buffer[32];
+
+        const auto decoded = mio::decode_uri(s, true, buffer);
+        assert(decoded == "caf\xC3\xA9 au lait");
+        assert(decoded->data() == buffer);
+    }
 }
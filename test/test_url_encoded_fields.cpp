@@ -0,0 +1,128 @@
+#include "mio/url_encoded_fields.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+#include "mio/http_request.hpp"
+
+namespace {
+    bool points_into(std::string_view s, std::string_view source) {
+        return source.data() <= s.data() && s.data() + s.size() <= source.data() + source.size();
+    }
+
+    void test_fields() {
+        const std::string_view source = "a=1&b=x%20y&&c&a=2&d=p+q&e=";
+
+        mio::url_encoded_fields fields{};
+        assert(!fields.parsed());
+
+        assert(fields.parse(source));
+        assert(fields.parsed());
+
+        assert(fields.entries().size() == 6);
+        assert(fields.get("a") == "1");
+        assert(fields.get("b") == "x y");
+        assert(fields.get("c") == "");
+        assert(fields.get("d") == "p q");
+        assert(fields.get("e") == "");
+        assert(fields.get("f") == std::nullopt);
+        assert(std::ranges::equal(fields.get_all("a"), std::initializer_list<std::string_view>{"1", "2"}));
+        assert(std::ranges::empty(fields.get_all("f")));
+
+        // Plain fields are borrowed from the source; escaped ones are decoded.
+        assert(points_into(*fields.get("a"), source));
+        assert(!points_into(*fields.get("b"), source));
+    }
+
+    void test_invalid() {
+        mio::url_encoded_fields fields{};
+
+        // Malformed fields are left out; the error sticks until the fields are reset.
+        const auto result = fields.parse("a=%2&b=1&%zz=2&c=%41");
+        assert(!result);
+        assert(result.error() == mio::request_error::bad_request);
+        assert(fields.parsed());
+        assert(fields.entries().size() == 2);
+        assert(fields.get("a") == std::nullopt);
+        assert(fields.get("b") == "1");
+        assert(fields.get("c") == "A");
+        assert(!fields.parse("a=%2&b=1&%zz=2&c=%41"));
+
+        fields.reset();
+        assert(fields.parse("a=1"));
+        assert(fields.get("a") == "1");
+    }
+
+    void test_request_query() {
+        {
+            mio::http_request req{"GET", "/search?q=mio%2Bhttp&tag=c%2B%2B&tag=web&page=2", "HTTP/1.1", mio::http_headers{}};
+
+            assert(req.path() == "/search");
+            assert(req.query_string() == "q=mio%2Bhttp&tag=c%2B%2B&tag=web&page=2");
+            assert(req.query("q") == "mio+http");
+            assert(req.query("page") == "2");
+            assert(req.query("none") == std::nullopt);
+            assert(std::ranges::equal(req.query_values("tag"), std::initializer_list<std::string_view>{"c++", "web"}));
+            assert(req.query_params().size() == 4);
+            assert(points_into(*req.query("page"), req.request_uri()));
+
+            // Moving the request drops the parsed state; it is parsed again from the moved URI.
+            mio::http_request moved{std::move(req)};
+            assert(moved.query("page") == "2");
+            assert(points_into(*moved.query("page"), moved.request_uri()));
+        }
+        {
+            mio::http_request req{"GET", "/", "HTTP/1.1", mio::http_headers{}};
+
+            assert(req.query_string() == "");
+            assert(req.query("q") == std::nullopt);
+            assert(req.query_params().empty());
+        }
+    }
+
+    mio::http_request make_form_request(std::string_view content_type, std::string_view body) {
+        const auto bytes = std::as_bytes(std::span{body});
+
+        mio::http_headers headers{};
+        headers.set("Content-Type", content_type);
+        return mio::http_request{"POST", "/", "HTTP/1.1", std::move(headers), std::pmr::vector<std::byte>(std::begin(bytes), std::end(bytes))};
+    }
+
+    void test_request_form() {
+        {
+            const auto req = make_form_request("application/x-www-form-urlencoded; charset=utf-8", "name=a+b&content=x%21&tag=1&tag=2");
+
+            assert(req.form("name") == "a b");
+            assert(req.form("content") == "x!");
+            assert(req.form("none") == std::nullopt);
+            assert(std::ranges::equal(req.form_values("tag"), std::initializer_list<std::string_view>{"1", "2"}));
+            assert(req.form_params().size() == 4);
+            assert(points_into(*req.form("tag"), req.body_as_text()));
+        }
+        {
+            const auto req = make_form_request("text/plain", "name=a");
+
+            assert(req.form("name") == std::nullopt);
+            assert(req.form_params().empty());
+        }
+        {
+            // A malformed body costs nothing until the form is read.
+            const auto req = make_form_request("application/x-www-form-urlencoded", "name=%zz&page=1");
+
+            assert(req.form("name") == std::nullopt);
+            assert(req.form("page") == "1");
+
+            const auto result = req.parse_form();
+            assert(!result);
+            assert(result.error() == mio::request_error::bad_request);
+            assert(req.parse_query());
+        }
+    }
+} // namespace
+
+void test_url_encoded_fields() {
+    test_fields();
+    test_invalid();
+    test_request_query();
+    test_request_form();
+}
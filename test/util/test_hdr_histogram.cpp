@@ -0,0 +1,89 @@
+#include "mio/util/hdr_histogram.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+namespace {
+    using mio::util::hdr_histogram;
+
+    void test_hdr_histogram_buckets() {
+        // Small values are exact.
+        for (std::uint64_t v = 0; v < hdr_histogram::sub_bucket_count; v++) {
+            assert(hdr_histogram::index_of(v) == v);
+            assert(hdr_histogram::lowest_equivalent(v) == v);
+        }
+
+        // Every value lies in its bucket, buckets abut, and their width stays within 1/1024 of the value.
+        std::size_t previous = hdr_histogram::index_of(hdr_histogram::sub_bucket_count - 1);
+        for (std::uint64_t v = hdr_histogram::sub_bucket_count; v < (std::uint64_t{1} << 20); v++) {
+            const auto index = hdr_histogram::index_of(v);
+            assert(index == previous || index == previous + 1);
+            assert(hdr_histogram::lowest_equivalent(index) <= v && v <= hdr_histogram::highest_equivalent(index));
+            assert((hdr_histogram::highest_equivalent(index) - hdr_histogram::lowest_equivalent(index)) * 1024 <= v);
+            previous = index;
+        }
+
+        const std::uint64_t large = (std::uint64_t{1} << 39) + 12345;
+        const auto index = hdr_histogram::index_of(large);
+        assert(hdr_histogram::lowest_equivalent(index) <= large && large <= hdr_histogram::highest_equivalent(index));
+    }
+
+    void test_hdr_histogram_percentiles() {
+        hdr_histogram h{};
+        assert(h.count() == 0);
+        assert(h.percentile(99) == 0);
+
+        for (std::uint64_t v = 1; v <= 1000; v++) {
+            h.record(v);
+        }
+
+        assert(h.count() == 1000);
+        assert(h.min() == 1);
+        assert(h.max() == 1000);
+        assert(h.mean() == 500.5);
+        assert(h.percentile(50) == 500);
+        assert(h.percentile(99) == 990);
+        assert(h.percentile(99.9) == 999);
+        assert(h.percentile(100) == 1000);
+        assert(h.percentile(0) == 1);
+
+        // Large values keep three significant digits.
+        hdr_histogram latencies{};
+        latencies.record(1'000'000, 99);
+        latencies.record(250'000'000);
+
+        const auto p50 = latencies.percentile(50);
+        assert(1'000'000 <= p50 && p50 < 1'001'000);
+        assert(latencies.percentile(100) == 250'000'000);
+    }
+
+    void test_hdr_histogram_merge() {
+        hdr_histogram a{};
+        hdr_histogram b{};
+
+        a.record(10, 3);
+        b.record(5'000'000);
+        b.record(1);
+
+        a.merge(b);
+        assert(a.count() == 5);
+        assert(a.min() == 1);
+        assert(a.max() == 5'000'000);
+        assert(a.percentile(50) == 10);
+
+        a.reset();
+        assert(a.count() == 0);
+        assert(a.max() == 0);
+
+        // Values past the highest trackable one are clamped.
+        hdr_histogram small{100'000};
+        small.record(1'000'000);
+        assert(small.max() == 100'000);
+    }
+} // namespace
+
+void test_hdr_histogram() {
+    test_hdr_histogram_buckets();
+    test_hdr_histogram_percentiles();
+    test_hdr_histogram_merge();
+}
@@ -0,0 +1,49 @@
+#include "mio/util/temporary_file.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    void test_temporary_file_unnamed() {
+        const auto directory = std::filesystem::temp_directory_path() / "mio-test-temporary-file";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directory(directory);
+
+        {
+            const auto fd = mio::util::open_temporary_file(directory.string());
+            assert(fd);
+
+            assert(::write(fd.get(), "hello", 5) == 5);
+            assert(::lseek(fd.get(), 0, SEEK_SET) == 0);
+
+            char buffer[8];
+            assert(::read(fd.get(), buffer, sizeof(buffer)) == 5);
+
+            struct ::stat st {};
+            assert(::fstat(fd.get(), &st) == 0);
+            assert(st.st_size == 5);
+
+            // Nothing shows up in the directory.
+            assert(std::filesystem::is_empty(directory));
+        }
+
+        std::filesystem::remove_all(directory);
+    }
+
+    void test_temporary_file_missing_directory() {
+        try {
+            mio::util::open_temporary_file("/nonexistent/mio");
+            assert(false);
+        } catch (const std::system_error&) {
+        }
+    }
+} // namespace
+
+void test_temporary_file() {
+    test_temporary_file_unnamed();
+    test_temporary_file_missing_directory();
+}
@@ -0,0 +1,117 @@
+#include "mio/util/timer_wheel.hpp"
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace {
+    using namespace std::chrono_literals;
+
+    using clock = mio::util::timer_wheel::clock;
+
+    void test_timer_wheel_fire() {
+        const auto origin = clock::time_point{};
+        mio::util::timer_wheel wheel{10ms, origin};
+
+        std::vector<int> fired{};
+        mio::util::timer_wheel::timer a{[&] { fired.push_back(1); }};
+        mio::util::timer_wheel::timer b{[&] { fired.push_back(2); }};
+        mio::util::timer_wheel::timer c{[&] { fired.push_back(3); }};
+
+        wheel.schedule(a, origin + 30ms);
+        wheel.schedule(b, origin + 15ms); // Rounded up to 20ms.
+        wheel.schedule(c, origin - 1s);   // Already due; fires on the next tick.
+        assert(wheel.size() == 3);
+
+        assert(wheel.advance(origin + 9ms) == 0);
+        assert(wheel.advance(origin + 10ms) == 1);
+        assert((fired == std::vector{3}));
+
+        assert(wheel.advance(origin + 19ms) == 0);
+        assert(wheel.advance(origin + 40ms) == 2);
+        assert((fired == std::vector{3, 2, 1}));
+        assert(wheel.size() == 0);
+        assert(!a.is_scheduled() && !b.is_scheduled() && !c.is_scheduled());
+    }
+
+    void test_timer_wheel_cancel() {
+        const auto origin = clock::time_point{};
+        mio::util::timer_wheel wheel{1ms, origin};
+
+        int fired = 0;
+        mio::util::timer_wheel::timer a{[&] { fired++; }};
+        mio::util::timer_wheel::timer b{[&] { fired += 10; }};
+
+        wheel.schedule(a, origin + 5ms);
+        wheel.schedule(b, origin + 5ms);
+        wheel.cancel(a);
+        wheel.cancel(a);
+        assert(wheel.size() == 1);
+
+        // Rescheduling moves the timer instead of adding it twice.
+        wheel.schedule(b, origin + 100ms);
+        wheel.schedule(b, origin + 200ms);
+        assert(wheel.size() == 1);
+
+        wheel.advance(origin + 199ms);
+        assert(fired == 0);
+
+        wheel.advance(origin + 200ms);
+        assert(fired == 10);
+    }
+
+    void test_timer_wheel_cascade() {
+        const auto origin = clock::time_point{};
+        mio::util::timer_wheel wheel{1ms, origin};
+
+        // Deadlines on every level, including ones that land in the slot of the current position.
+        const std::vector<int> deadlines{1, 63, 64, 65, 127, 128, 4095, 4096, 4097, 5000, 262143, 262144, 300000, 1000000};
+
+        std::vector<int> fired_at{};
+        std::vector<std::unique_ptr<mio::util::timer_wheel::timer>> timers{};
+
+        wheel.advance(origin + 100ms);
+        for (const auto deadline : deadlines) {
+            auto& t = timers.emplace_back(std::make_unique<mio::util::timer_wheel::timer>([&, deadline] { fired_at.push_back(deadline); }));
+            wheel.schedule(*t, origin + 100ms + std::chrono::milliseconds{deadline});
+        }
+
+        for (int now = 100; now <= 1000100; now++) {
+            const auto before = fired_at.size();
+            wheel.advance(origin + std::chrono::milliseconds{now});
+
+            for (auto i = before; i < fired_at.size(); i++) {
+                assert(fired_at[i] + 100 == now);
+            }
+        }
+
+        assert(fired_at == deadlines);
+        assert(wheel.size() == 0);
+    }
+
+    void test_timer_wheel_reschedule_from_callback() {
+        const auto origin = clock::time_point{};
+        mio::util::timer_wheel wheel{1ms, origin};
+
+        int fired = 0;
+        mio::util::timer_wheel::timer* self = nullptr;
+        mio::util::timer_wheel::timer t{[&] {
+            if (++fired < 3) {
+                wheel.schedule(*self, origin); // Due already; must not fire again within the same tick.
+            }
+        }};
+        self = &t;
+
+        wheel.schedule(t, origin + 1ms);
+        assert(wheel.advance(origin + 1ms) == 1);
+        assert(wheel.advance(origin + 10ms) == 2);
+        assert(fired == 3);
+    }
+} // namespace
+
+void test_timer_wheel() {
+    test_timer_wheel_fire();
+    test_timer_wheel_cancel();
+    test_timer_wheel_cascade();
+    test_timer_wheel_reschedule_from_callback();
+}